@@ -156,7 +156,7 @@ void SoldierAvatarState::initPreview(Soldier *s)
 			ss << (int)s->getLook() + (s->getLookVariant() & (RuleSoldier::LookVariantMask >> i)) * 4;
 			ss << ".SPK";
 			std::string debug = ss.str();
-			surf = _game->getMod()->getSurface(ss.str(), false);
+			surf = _game->getMod()->getSurfaceTransient(ss.str(), false);
 			if (surf)
 			{
 				break;
@@ -167,11 +167,11 @@ void SoldierAvatarState::initPreview(Soldier *s)
 			ss.str("");
 			ss << look;
 			ss << ".SPK";
-			surf = _game->getMod()->getSurface(ss.str(), false);
+			surf = _game->getMod()->getSurfaceTransient(ss.str(), false);
 		}
 		if (!surf)
 		{
-			surf = _game->getMod()->getSurface(look, true);
+			surf = _game->getMod()->getSurfaceTransient(look, true);
 		}
 		surf->blitNShade(_soldierSurface, 0, 0);
 	}
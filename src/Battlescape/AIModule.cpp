@@ -31,6 +31,8 @@
 #include "../Engine/RNG.h"
 #include "../Engine/Logger.h"
 #include "../Engine/Game.h"
+#include "../Engine/ThreadPool.h"
+#include "../Engine/FrameTrace.h"
 #include "../Mod/Armor.h"
 #include "../Mod/Mod.h"
 #include "../Mod/RuleItem.h"
@@ -196,6 +198,7 @@ void AIModule::dont_think(BattleAction *action)
  */
 void AIModule::think(BattleAction *action)
 {
+	FrameTraceScope trace("AIModule::think");
 	action->type = BA_RETHINK;
 	action->actor = _unit;
 	action->weapon = _unit->getMainHandWeapon(false);
@@ -683,19 +686,47 @@ void AIModule::setupAmbush()
 		const int COVER_BONUS = 25;
 		const int FAST_PASS_THRESHOLD = 80;
 		Position origin = _save->getTileEngine()->getSightOriginVoxel(_aggroTarget);
+		const std::vector<Node*> &nodes = *_save->getNodes();
 
-		// we'll use node positions for this, as it gives map makers a good degree of control over how the units will use the environment.
-		for (std::vector<Node*>::const_iterator i = _save->getNodes()->begin(); i != _save->getNodes()->end(); ++i)
+		auto isCandidate = [&](const Node *node)
 		{
-			if ((*i)->isDummy())
+			if (node->isDummy())
 			{
-				continue;
+				return false;
 			}
-			Position pos = (*i)->getPosition();
+			Position pos = node->getPosition();
 			Tile *tile = _save->getTile(pos);
-			if (tile == 0 || Position::distance2d(pos, _unit->getPosition()) > 10 || pos.z != _unit->getPosition().z || tile->getDangerous() ||
-				std::find(_reachableWithAttack.begin(), _reachableWithAttack.end(), _save->getTileIndex(pos))  == _reachableWithAttack.end())
+			return !(tile == 0 || Position::distance2d(pos, _unit->getPosition()) > 10 || pos.z != _unit->getPosition().z || tile->getDangerous() ||
+				std::find(_reachableWithAttack.begin(), _reachableWithAttack.end(), _save->getTileIndex(pos))  == _reachableWithAttack.end());
+		};
+		auto isHidden = [&](VoxelCheckCache &cache, Position pos)
+		{
+			Position target;
+			return !_save->getTileEngine()->canTargetUnit(cache, &origin, _save->getTile(pos), &target, _aggroTarget, false, _unit) && !getSpottingUnits(cache, pos);
+		};
+
+		// this only reads the map, so worker threads can check all nodes before we choose one.
+		std::vector<Sint8> hidden;
+		if (Options::oxceThreadedAI)
+		{
+			hidden.resize(nodes.size(), -1);
+			ThreadPool::getShared().parallelFor(nodes.size(), [&](size_t n)
+			{
+				if (isCandidate(nodes[n]))
+				{
+					VoxelCheckCache cache;
+					hidden[n] = isHidden(cache, nodes[n]->getPosition());
+				}
+			});
+		}
+
+		// we'll use node positions for this, as it gives map makers a good degree of control over how the units will use the environment.
+		for (size_t n = 0; n < nodes.size(); ++n)
+		{
+			if (!isCandidate(nodes[n]))
 				continue; // just ignore unreachable tiles
+			Position pos = nodes[n]->getPosition();
+			Tile *tile = _save->getTile(pos);
 
 			if (_traceAI)
 			{
@@ -705,8 +736,8 @@ void AIModule::setupAmbush()
 			}
 
 			// make sure we can't be seen here.
-			Position target;
-			if (!_save->getTileEngine()->canTargetUnit(&origin, tile, &target, _aggroTarget, false, _unit) && !getSpottingUnits(pos))
+			VoxelCheckCache cache;
+			if (hidden.empty() ? isHidden(cache, pos) : hidden[n] == 1)
 			{
 				_save->getPathfinding()->calculate(_unit, pos);
 				int ambushTUs = _save->getPathfinding()->getTotalTUCost();
@@ -907,6 +938,39 @@ void AIModule::setupEscape()
 	std::vector<Position> randomTileSearch = _save->getTileSearch();
 	RNG::shuffle(randomTileSearch);
 
+	// positions of systematic search are known upfront, worker threads can check who see them.
+	// positions that need RNG are left for main loop, so random numbers are drawn in same order.
+	std::vector<int> systematicSpotters;
+	if (Options::oxceThreadedAI)
+	{
+		systematicSpotters.resize(122, -1);
+		ThreadPool::getShared().parallelFor(systematicSpotters.size(), [&](size_t n)
+		{
+			Position pos = _unit->getPosition();
+			if (n == 0)
+			{
+				if (_save->getTile(_unit->lastCover) != 0)
+				{
+					pos = _unit->lastCover;
+				}
+			}
+			else
+			{
+				pos.x += randomTileSearch[n - 1].x;
+				pos.y += randomTileSearch[n - 1].y;
+				if (pos == _unit->getPosition() && unitsSpottingMe > 0)
+				{
+					return;
+				}
+			}
+			if (_save->getTile(pos) && std::find(_reachable.begin(), _reachable.end(), _save->getTileIndex(pos)) != _reachable.end())
+			{
+				VoxelCheckCache cache;
+				systematicSpotters[n] = getSpottingUnits(cache, pos);
+			}
+		});
+	}
+
 	while (tries < 150 && !coverFound)
 	{
 		_escapeAction.target = _unit->getPosition(); // start looking in a direction away from the enemy
@@ -992,9 +1056,16 @@ void AIModule::setupEscape()
 		}
 		else
 		{
-			spotters = getSpottingUnits(_escapeAction.target);
 			if (std::find(_reachable.begin(), _reachable.end(), _save->getTileIndex(_escapeAction.target))  == _reachable.end())
 				continue; // just ignore unreachable tiles
+			if (tries < (int)systematicSpotters.size() && systematicSpotters[tries] != -1)
+			{
+				spotters = systematicSpotters[tries];
+			}
+			else
+			{
+				spotters = getSpottingUnits(_escapeAction.target);
+			}
 
 			if (_spottingEnemies || spotters)
 			{
@@ -1101,6 +1172,19 @@ int AIModule::countKnownTargets() const
  * @return spotters.
  */
 int AIModule::getSpottingUnits(const Position& pos) const
+{
+	VoxelCheckCache cache;
+	return getSpottingUnits(cache, pos);
+}
+
+/**
+ * Counts how many enemy units are able to see this position, using given voxel cache.
+ * It does not change anything, so worker threads can call it with their own cache.
+ * @param cache Voxel cache of current thread.
+ * @param pos the Position to check for spotters.
+ * @return spotters.
+ */
+int AIModule::getSpottingUnits(VoxelCheckCache &cache, const Position& pos) const
 {
 	// if we don't actually occupy the position being checked, we need to do a virtual LOF check.
 	bool checking = pos != _unit->getPosition();
@@ -1116,14 +1200,14 @@ int AIModule::getSpottingUnits(const Position& pos) const
 			Position targetVoxel;
 			if (checking)
 			{
-				if (_save->getTileEngine()->canTargetUnit(&originVoxel, _save->getTile(pos), &targetVoxel, *i, false, _unit))
+				if (_save->getTileEngine()->canTargetUnit(cache, &originVoxel, _save->getTile(pos), &targetVoxel, *i, false, _unit))
 				{
 					tally++;
 				}
 			}
 			else
 			{
-				if (_save->getTileEngine()->canTargetUnit(&originVoxel, _save->getTile(pos), &targetVoxel, *i, false))
+				if (_save->getTileEngine()->canTargetUnit(cache, &originVoxel, _save->getTile(pos), &targetVoxel, *i, false, nullptr))
 				{
 					tally++;
 				}
@@ -1811,33 +1895,59 @@ bool AIModule::findFirePoint()
 		return false;
 	std::vector<Position> randomTileSearch = _save->getTileSearch();
 	RNG::shuffle(randomTileSearch);
-	Position target;
 	const int BASE_SYSTEMATIC_SUCCESS = 100;
 	const int FAST_PASS_THRESHOLD = 125;
 	bool waitIfOutsideWeaponRange = _unit->getGeoscapeSoldier() ? false : _unit->getUnitRules()->waitIfOutsideWeaponRange();
 	bool extendedFireModeChoiceEnabled = _save->getBattleGame()->getMod()->getAIExtendedFireModeChoice();
 	int bestScore = 0;
 	_attackAction.type = BA_RETHINK;
-	for (std::vector<Position>::const_iterator i = randomTileSearch.begin(); i != randomTileSearch.end(); ++i)
+
+	auto isCandidate = [&](Position pos)
+	{
+		return _save->getTile(pos) != 0 &&
+			std::find(_reachableWithAttack.begin(), _reachableWithAttack.end(), _save->getTileIndex(pos)) != _reachableWithAttack.end();
+	};
+	auto canTarget = [&](VoxelCheckCache &cache, Position pos)
 	{
-		Position pos = _unit->getPosition() + *i;
-		Tile *tile = _save->getTile(pos);
-		if (tile == 0  ||
-			std::find(_reachableWithAttack.begin(), _reachableWithAttack.end(), _save->getTileIndex(pos))  == _reachableWithAttack.end())
-			continue;
-		int score = 0;
 		// i should really make a function for this
 		Position origin = pos.toVoxel() +
 			// 4 because -2 is eyes and 2 below that is the rifle (or at least that's my understanding)
-			Position(8,8, _unit->getHeight() + _unit->getFloatHeight() - tile->getTerrainLevel() - 4);
+			Position(8,8, _unit->getHeight() + _unit->getFloatHeight() - _save->getTile(pos)->getTerrainLevel() - 4);
+		Position target;
+		return _save->getTileEngine()->canTargetUnit(cache, &origin, _aggroTarget->getTile(), &target, _unit, false, nullptr);
+	};
+
+	// this only reads the map, so worker threads can check all positions before we choose one.
+	std::vector<int> spotters;
+	if (Options::oxceThreadedAI)
+	{
+		spotters.resize(randomTileSearch.size(), -1);
+		ThreadPool::getShared().parallelFor(randomTileSearch.size(), [&](size_t n)
+		{
+			Position pos = _unit->getPosition() + randomTileSearch[n];
+			VoxelCheckCache cache;
+			if (isCandidate(pos) && canTarget(cache, pos))
+			{
+				spotters[n] = getSpottingUnits(cache, pos);
+			}
+		});
+	}
+
+	for (size_t n = 0; n < randomTileSearch.size(); ++n)
+	{
+		Position pos = _unit->getPosition() + randomTileSearch[n];
+		if (!isCandidate(pos))
+			continue;
+		int score = 0;
 
-		if (_save->getTileEngine()->canTargetUnit(&origin, _aggroTarget->getTile(), &target, _unit, false))
+		VoxelCheckCache cache;
+		if (spotters.empty() ? canTarget(cache, pos) : spotters[n] != -1)
 		{
 			_save->getPathfinding()->calculate(_unit, pos);
 			// can move here
 			if (_save->getPathfinding()->getStartDirection() != -1)
 			{
-				score = BASE_SYSTEMATIC_SUCCESS - getSpottingUnits(pos) * 10;
+				score = BASE_SYSTEMATIC_SUCCESS - (spotters.empty() ? getSpottingUnits(cache, pos) : spotters[n]) * 10;
 				score += _unit->getTimeUnits() - _save->getPathfinding()->getTotalTUCost();
 				if (!_aggroTarget->checkViewSector(pos))
 				{
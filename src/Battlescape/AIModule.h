@@ -32,6 +32,7 @@ class BattleUnit;
 struct BattleAction;
 class BattlescapeState;
 class Node;
+struct VoxelCheckCache;
 
 enum AIMode { AI_PATROL, AI_AMBUSH, AI_COMBAT, AI_ESCAPE };
 /**
@@ -94,6 +95,8 @@ public:
 	int countKnownTargets() const;
 	/// count how many known XCom units are able to see this unit.
 	int getSpottingUnits(const Position& pos) const;
+	/// count how many known XCom units are able to see this unit, using given voxel cache.
+	int getSpottingUnits(VoxelCheckCache &cache, const Position& pos) const;
 	/// Selects the nearest target we can see, and return the number of viable targets.
 	int selectNearestTarget();
 	/// Selects the closest known xcom unit for ambushing.
@@ -171,7 +171,7 @@ AlienInventoryState::AlienInventoryState(BattleUnit *unit)
 				ss << gender;
 				ss << (int)s->getLook() + (s->getLookVariant() & (RuleSoldier::LookVariantMask >> i)) * 4;
 				ss << ".SPK";
-				surf = _game->getMod()->getSurface(ss.str(), false);
+				surf = _game->getMod()->getSurfaceTransient(ss.str(), false);
 				if (surf)
 				{
 					break;
@@ -182,11 +182,11 @@ AlienInventoryState::AlienInventoryState(BattleUnit *unit)
 				ss.str("");
 				ss << look;
 				ss << ".SPK";
-				surf = _game->getMod()->getSurface(ss.str(), false);
+				surf = _game->getMod()->getSurfaceTransient(ss.str(), false);
 			}
 			if (!surf)
 			{
-				surf = _game->getMod()->getSurface(look, true);
+				surf = _game->getMod()->getSurfaceTransient(look, true);
 			}
 			surf->blitNShade(_soldier, 0, 0);
 		}
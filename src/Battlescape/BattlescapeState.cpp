@@ -2041,7 +2041,7 @@ void BattlescapeState::updateSoldierInfo(bool checkFOV)
 					ss << gender;
 					ss << (int)soldier->getLook() + (soldier->getLookVariant() & (RuleSoldier::LookVariantMask >> i)) * 4;
 					ss << ".SPK";
-					surf = _game->getMod()->getSurface(ss.str(), false);
+					surf = _game->getMod()->getSurfaceTransient(ss.str(), false);
 					if (surf)
 					{
 						break;
@@ -2052,11 +2052,11 @@ void BattlescapeState::updateSoldierInfo(bool checkFOV)
 					ss.str("");
 					ss << look;
 					ss << ".SPK";
-					surf = _game->getMod()->getSurface(ss.str(), false);
+					surf = _game->getMod()->getSurfaceTransient(ss.str(), false);
 				}
 				if (!surf)
 				{
-					surf = _game->getMod()->getSurface(look, true);
+					surf = _game->getMod()->getSurfaceTransient(look, true);
 				}
 
 				// crop
@@ -2737,8 +2737,8 @@ inline void BattlescapeState::handle(Action *action)
 							}
 						}
 					}
-					// f11 - voxel map dump
-					else if (key == SDLK_F11)
+					// f11 - voxel map dump (ctrl-f11 saves frame trace)
+					else if (key == SDLK_F11 && !ctrlPressed)
 					{
 						saveVoxelMap();
 					}
@@ -68,7 +68,7 @@ void ItemSprite::draw(BattleItem* item, int x, int y, int shade)
 	{
 		ScriptWorkerBlit work;
 		BattleItem::ScriptFill(&work, item, BODYPART_ITEM_FLOOR, _animationFrame, shade);
-		work.executeBlit(sprite, _dest, x, y, shade);
+		work.executeBlitCached(sprite, _dest, x, y, shade);
 	}
 }
 
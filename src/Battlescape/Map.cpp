@@ -36,6 +36,8 @@
 #include "../Engine/Screen.h"
 #include "../Engine/ShaderDraw.h"
 #include "../Engine/ShaderMove.h"
+#include "../Engine/Script.h"
+#include "../Engine/FrameTrace.h"
 #include "../Savegame/SavedBattleGame.h"
 #include "../Savegame/Tile.h"
 #include "../Savegame/BattleUnit.h"
@@ -98,7 +100,7 @@ Map::Map(Game *game, int width, int height, int x, int y, int visibleMapHeight)
 	_game(game), _arrow(0), _anyIndicator(false), _isAltPressed(false),
 	_selectorX(0), _selectorY(0), _mouseX(0), _mouseY(0), _cursorType(CT_NORMAL), _cursorSize(1), _animFrame(0),
 	_projectile(0), _followProjectile(true), _projectileInFOV(false), _explosionInFOV(false), _launch(false), _visibleMapHeight(visibleMapHeight),
-	_unitDying(false), _smoothingEngaged(false), _flashScreen(false), _bgColor(15), _projectileSet(0), _showObstacles(false)
+	_unitDying(false), _smoothingEngaged(false), _flashScreen(false), _bgColor(15), _projectileSet(0), _dirtyBuffer(0), _redrawDirtyOnly(false), _showObstacles(false)
 {
 	_iconHeight = _game->getMod()->getInterface("battlescape")->getElement("icons")->h;
 	_iconWidth = _game->getMod()->getInterface("battlescape")->getElement("icons")->w;
@@ -187,6 +189,14 @@ Map::~Map()
 	delete _message;
 	delete _camera;
 	delete _txtAccuracy;
+	delete _dirtyBuffer;
+
+	ScriptWorkerBlit::clearCache();
+	if (Options::oxceScriptProfiler)
+	{
+		// 1 - log only, 2 - log and save CSV
+		ScriptProfiler::report(Options::oxceScriptProfiler > 1 ? Options::getUserFolder() + "scriptProfile.csv" : "");
+	}
 }
 
 /**
@@ -247,19 +257,7 @@ void Map::draw()
 		return;
 	}
 
-	// normally we'd call for a Surface::draw();
-	// but we don't want to clear the background with colour 0, which is transparent (aka black)
-	// we use colour 15 because that actually corresponds to the colour we DO want in all variations of the xcom and tftd palettes.
-	// Note: un-hardcoded the color from 15 to ruleset value, default 15
 	_redraw = false;
-	ShaderDrawFunc(
-		[](Uint8& dest, Uint8 color)
-		{
-			dest = color;
-		},
-		ShaderSurface(this),
-		ShaderScalar<Uint8>(Palette::blockOffset(0) + _bgColor)
-	);
 
 	Tile *t;
 
@@ -286,14 +284,147 @@ void Map::draw()
 		}
 	}
 
-	if ((_save->getSelectedUnit() && _save->getSelectedUnit()->getVisible()) || _unitDying || _save->getSide() == FACTION_PLAYER || _save->getDebugMode() || _projectileInFOV || _explosionInFOV)
+	const bool drawMap = (_save->getSelectedUnit() && _save->getSelectedUnit()->getVisible()) || _unitDying || _save->getSide() == FACTION_PLAYER || _save->getDebugMode() || _projectileInFOV || _explosionInFOV;
+	if (drawMap && canRedrawDirtyOnly())
 	{
-		drawTerrain(this);
+		drawDirtyAreas();
 	}
 	else
 	{
-		_message->blit(this->getSurface());
+		// normally we'd call for a Surface::draw();
+		// but we don't want to clear the background with colour 0, which is transparent (aka black)
+		// we use colour 15 because that actually corresponds to the colour we DO want in all variations of the xcom and tftd palettes.
+		// Note: un-hardcoded the color from 15 to ruleset value, default 15
+		ShaderDrawFunc(
+			[](Uint8& dest, Uint8 color)
+			{
+				dest = color;
+			},
+			ShaderSurface(this),
+			ShaderScalar<Uint8>(Palette::blockOffset(0) + _bgColor)
+		);
+
+		if (!_dirtyBuffer || _dirtyBuffer->getWidth() != getWidth() || _dirtyBuffer->getHeight() != getHeight())
+		{
+			delete _dirtyBuffer;
+			_dirtyBuffer = new Surface(getWidth(), getHeight());
+		}
+
+		if (drawMap)
+		{
+			drawTerrain(this, GraphSubset(getWidth(), getHeight()));
+		}
+		else
+		{
+			_message->blit(this->getSurface());
+		}
 	}
+
+	_dirtyAreas.clear();
+	_redrawDirtyOnly = false;
+	_dirtyCameraPos = _camera->getMapOffset();
+}
+
+/**
+ * Marks the whole map to be redrawn.
+ * @param valid true means redraw.
+ */
+void Map::invalidate(bool valid)
+{
+	Surface::invalidate(valid);
+	_redrawDirtyOnly = false;
+}
+
+/**
+ * Marks screen area of the selector as needing redraw.
+ * Selector is drawn on every level up to the current view level, with accuracy text next to it.
+ * @param selectorX X position of selector on map.
+ * @param selectorY Y position of selector on map.
+ */
+void Map::addDirtySelector(int selectorX, int selectorY)
+{
+	const int width = std::max(_spriteWidth, _txtAccuracy->getWidth());
+	const int height = std::max(_spriteHeight, _txtAccuracy->getHeight());
+	const auto cameraPos = _camera->getMapOffset();
+
+	for (int x = selectorX - _cursorSize + 1; x <= selectorX; ++x)
+	{
+		for (int y = selectorY - _cursorSize + 1; y <= selectorY; ++y)
+		{
+			Position top, bottom;
+			_camera->convertMapToScreen(Position(x, y, _camera->getViewLevel()), &top);
+			_camera->convertMapToScreen(Position(x, y, 0), &bottom);
+			top += cameraPos;
+			bottom += cameraPos;
+			_dirtyAreas.push_back(GraphSubset(std::make_pair(top.x, top.x + width), std::make_pair(top.y, bottom.y + height)));
+		}
+	}
+}
+
+/**
+ * Checks if only areas marked as dirty changed since last draw.
+ * Any scrolling, projectile, explosion or busy game state needs full redraw.
+ * @return True if it is enough to redraw only dirty areas.
+ */
+bool Map::canRedrawDirtyOnly() const
+{
+	return _redrawDirtyOnly
+		&& !_dirtyAreas.empty()
+		&& _dirtyBuffer
+		&& _dirtyBuffer->getWidth() == getWidth()
+		&& _dirtyBuffer->getHeight() == getHeight()
+		&& _dirtyCameraPos == _camera->getMapOffset()
+		&& !_projectile
+		&& _explosions.empty()
+		&& !_unitDying
+		&& !_flashScreen
+		&& !_save->getBattleGame()->isBusy();
+}
+
+/**
+ * Redraws only tiles that overlap dirty areas.
+ * Tiles are drawn to a helper surface, then only dirty areas are copied to map,
+ * this way parts of tiles outside of these areas do not overwrite anything drawn in front of them.
+ */
+void Map::drawDirtyAreas()
+{
+	GraphSubset area = _dirtyAreas.front();
+	for (const auto& a : _dirtyAreas)
+	{
+		area.beg_x = std::min(area.beg_x, a.beg_x);
+		area.end_x = std::max(area.end_x, a.end_x);
+		area.beg_y = std::min(area.beg_y, a.beg_y);
+		area.end_y = std::max(area.end_y, a.end_y);
+	}
+	area = GraphSubset::intersection(area, GraphSubset(getWidth(), getHeight()));
+	if (!area)
+	{
+		return;
+	}
+
+	ShaderMove<Uint8> buffer(_dirtyBuffer);
+	buffer.setDomain(area);
+	ShaderDrawFunc(
+		[](Uint8& dest, Uint8 color)
+		{
+			dest = color;
+		},
+		buffer,
+		ShaderScalar<Uint8>(Palette::blockOffset(0) + _bgColor)
+	);
+
+	drawTerrain(_dirtyBuffer, area);
+
+	ShaderMove<Uint8> dest(this);
+	dest.setDomain(area);
+	ShaderDrawFunc(
+		[](Uint8& d, Uint8 s)
+		{
+			d = s;
+		},
+		dest,
+		ShaderMove<Uint8>(_dirtyBuffer)
+	);
 }
 
 /**
@@ -305,6 +436,7 @@ void Map::draw()
 void Map::setPalette(const SDL_Color *colors, int firstcolor, int ncolors)
 {
 	Surface::setPalette(colors, firstcolor, ncolors);
+	_redrawDirtyOnly = false;
 	for (std::vector<MapDataSet*>::const_iterator i = _save->getMapDataSets()->begin(); i != _save->getMapDataSets()->end(); ++i)
 	{
 		(*i)->getSurfaceset()->setPalette(colors, firstcolor, ncolors);
@@ -643,8 +775,9 @@ void Map::drawUnit(UnitSprite &unitSprite, Tile *unitTile, Tile *currTile, Posit
  * Keep this function as optimised as possible. It's big to minimise overhead of function calls.
  * @param surface The surface to draw on.
  */
-void Map::drawTerrain(Surface *surface)
+void Map::drawTerrain(Surface *surface, GraphSubset area)
 {
+	FrameTraceScope trace("Map::drawTerrain");
 	_isAltPressed = _game->isAltPressed(true);
 	int frameNumber = 0;
 	SurfaceRaw<const Uint8> tmpSurface;
@@ -811,9 +944,9 @@ void Map::drawTerrain(Surface *surface)
 				_camera->convertMapToScreen(mapPosition, &screenPosition);
 				screenPosition += cameraPos;
 
-				// only render cells that are inside the surface
-				if (screenPosition.x > -_spriteWidth && screenPosition.x < surface->getWidth() + _spriteWidth &&
-					screenPosition.y > -_spriteHeight && screenPosition.y < surface->getHeight() + _spriteHeight )
+				// only render cells that are inside the drawn area of surface
+				if (screenPosition.x > area.beg_x - _spriteWidth && screenPosition.x < area.end_x + _spriteWidth &&
+					screenPosition.y > area.beg_y - _spriteHeight && screenPosition.y < area.end_y + _spriteHeight )
 				{
 					auto isUnitMovingNearby = movingUnit && positionInRangeXY(movingUnitPosition, mapPosition, 2);
 
@@ -1142,7 +1275,7 @@ void Map::drawTerrain(Surface *surface)
 										dest = transparetOffsets[dest];
 									}
 								},
-								ShaderSurface(this),
+								ShaderSurface(surface),
 								ShaderMove(pixelMask, vaporX, vaporY)
 							);
 						}
@@ -1754,6 +1887,12 @@ void Map::setSelectorPosition(int mx, int my)
 
 	if (oldX != _selectorX || oldY != _selectorY)
 	{
+		if (!_redraw || _redrawDirtyOnly)
+		{
+			_redrawDirtyOnly = true;
+			addDirtySelector(oldX, oldY);
+			addDirtySelector(_selectorX, _selectorY);
+		}
 		_redraw = true;
 	}
 }
@@ -1840,7 +1979,11 @@ void Map::animate(bool redraw)
 		}
 	}
 
-	if (redraw) _redraw = true;
+	if (redraw)
+	{
+		_redraw = true;
+		_redrawDirtyOnly = false;
+	}
 }
 
 /**
@@ -1994,6 +2137,9 @@ void Map::setCursorType(CursorType type, int size)
 		_cursorSize = size;
 	else
 		_cursorSize = 1;
+
+	// dirty areas were marked for old selector shape
+	_redrawDirtyOnly = false;
 }
 
 /**
@@ -101,9 +101,16 @@ private:
 	PathPreview _previewSetting;
 	Text *_txtAccuracy;
 	SurfaceSet *_projectileSet;
+	Surface *_dirtyBuffer;
+	std::vector<GraphSubset> _dirtyAreas;
+	Position _dirtyCameraPos;
+	bool _redrawDirtyOnly;
 
 	void drawUnit(UnitSprite &unitSprite, Tile *unitTile, Tile *currTile, Position tileScreenPosition, bool topLayer, BattleUnit* movingUnit = nullptr);
-	void drawTerrain(Surface *surface);
+	void drawTerrain(Surface *surface, GraphSubset area);
+	void addDirtySelector(int selectorX, int selectorY);
+	bool canRedrawDirtyOnly() const;
+	void drawDirtyAreas();
 	int getTerrainLevel(const Position& pos, int size) const;
 	int getWallShade(TilePart part, Tile* tileFrot);
 	int _iconHeight, _iconWidth, _messageColor;
@@ -120,6 +127,8 @@ public:
 	void think() override;
 	/// Draws the surface.
 	void draw() override;
+	/// Marks the whole map to be redrawn.
+	void invalidate(bool valid = true) override;
 	/// Sets the palette.
 	void setPalette(const SDL_Color *colors, int firstcolor = 0, int ncolors = 256) override;
 	/// Special handling for mouse press.
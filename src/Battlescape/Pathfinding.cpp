@@ -19,12 +19,12 @@
 #include <list>
 #include <algorithm>
 #include "Pathfinding.h"
-#include "PathfindingOpenSet.h"
 #include "../Savegame/SavedBattleGame.h"
 #include "../Savegame/Tile.h"
 #include "../Mod/Armor.h"
 #include "../Savegame/BattleUnit.h"
 #include "../Engine/Options.h"
+#include "../Engine/FrameTrace.h"
 #include "BattlescapeGame.h"
 #include "TileEngine.h"
 
@@ -43,7 +43,7 @@ int Pathfinding::green = 4;
  * Sets up a Pathfinding.
  * @param save pointer to SavedBattleGame object.
  */
-Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _unit(0), _pathPreviewed(false), _strafeMove(false), _totalTUCost(0), _modifierUsed(false), _movementType(MT_WALK)
+Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _searchGeneration(0), _reachableCacheVersion(0), _unit(0), _pathPreviewed(false), _strafeMove(false), _totalTUCost(0), _modifierUsed(false), _movementType(MT_WALK)
 {
 	_size = _save->getMapSizeXYZ();
 	// Initialize one node per tile
@@ -73,6 +73,36 @@ PathfindingNode *Pathfinding::getNode(Position pos)
 	return &_nodes[_save->getTileIndex(pos)];
 }
 
+/**
+ * Gets the Node on a given position on the map, resetting it when it was used by previous search.
+ * @param pos Position.
+ * @return Pointer to node.
+ */
+PathfindingNode *Pathfinding::getSearchNode(Position pos)
+{
+	PathfindingNode *node = getNode(pos);
+	node->prepare(_searchGeneration);
+	return node;
+}
+
+/**
+ * Starts new search, all nodes used by previous ones became stale.
+ * Only on wrap of generation counter all nodes need to be reset.
+ */
+void Pathfinding::startSearch()
+{
+	_openSet.clear();
+	++_searchGeneration;
+	if (_searchGeneration == 0)
+	{
+		for (auto& node : _nodes)
+		{
+			node.reset(0);
+		}
+		_searchGeneration = 1;
+	}
+}
+
 /**
  * Calculates the shortest path.
  * @param unit Unit taking the path.
@@ -82,6 +112,7 @@ PathfindingNode *Pathfinding::getNode(Position pos)
  */
 void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleUnit *target, int maxTUCost)
 {
+	FrameTraceScope trace("Pathfinding::calculate");
 	_totalTUCost = 0;
 	_path.clear();
 	// i'm DONE with these out of bounds errors.
@@ -165,14 +196,13 @@ void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleUnit *
  */
 bool Pathfinding::aStarPath(Position startPosition, Position endPosition, BattleUnit *target, bool sneak, int maxTUCost)
 {
-	// reset every node, so we have to check them all
-	for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
-		it->reset();
+	// invalidate every node, so we have to check them all
+	startSearch();
 
 	// start position is the first one in our "open" list
-	PathfindingNode *start = getNode(startPosition);
+	PathfindingNode *start = getSearchNode(startPosition);
 	start->connect(0, 0, 0, endPosition);
-	PathfindingOpenSet openList;
+	PathfindingOpenSet &openList = _openSet;
 	openList.push(start);
 	bool missile = (target && maxTUCost == 10000);
 	// if the open list is empty, we've reached the end
@@ -201,7 +231,7 @@ bool Pathfinding::aStarPath(Position startPosition, Position endPosition, Battle
 			if (tuCost >= 255) // Skip unreachable / blocked
 				continue;
 			if (sneak && _save->getTile(nextPos)->getVisible()) tuCost *= 2; // avoid being seen
-			PathfindingNode *nextNode = getNode(nextPos);
+			PathfindingNode *nextNode = getSearchNode(nextPos);
 			if (nextNode->isChecked()) // Our algorithm means this node is already at minimum cost.
 				continue;
 			_totalTUCost = currentNode->getTUCost(missile) + tuCost;
@@ -1139,23 +1169,92 @@ bool Pathfinding::bresenhamPath(Position origin, Position target, BattleUnit *ta
 
 /**
  * Locates all tiles reachable to @a *unit with a TU cost no more than @a tuMax.
- * Uses Dijkstra's algorithm.
+ * Result is cached per unit and reused until unit or map change.
  * @param unit Pointer to the unit.
  * @param tuMax The maximum cost of the path to each tile.
  * @return An array of reachable tiles, sorted in ascending order of cost. The first tile is the start location.
  */
 std::vector<int> Pathfinding::findReachable(BattleUnit *unit, const BattleActionCost &cost)
 {
-	const Position start = unit->getPosition();
 	int tuMax = unit->getTimeUnits() - cost.Time;
 	int energyMax = unit->getEnergy() - cost.Energy;
-	for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
+	return getReachable(unit, tuMax, energyMax).getTiles(tuMax, energyMax);
+}
+
+/**
+ * Gets the reachability field of @a *unit that cover given budget.
+ * Field calculated earlier is reused if nothing on map changed since then.
+ * @param unit Pointer to the unit.
+ * @param tuMax The maximum TU cost of the path to each tile.
+ * @param energyMax The maximum energy cost of the path to each tile.
+ * @return Reachability field, valid until next call.
+ */
+const PathfindingReachable &Pathfinding::getReachable(BattleUnit *unit, int tuMax, int energyMax)
+{
+	if (_reachableCacheVersion != _save->getMapVersion())
 	{
-		it->reset();
+		_reachableCache.clear();
+		_reachableCacheVersion = _save->getMapVersion();
 	}
-	PathfindingNode *startNode = getNode(start);
+	const Uint32 knownUnits = getKnownUnitsHash();
+	auto& field = _reachableCache[unit->getId()];
+	if (!field.isValid(unit, _unit, _movementType, tuMax, energyMax, _reachableCacheVersion, knownUnits))
+	{
+		// use whole unit budget, queries with attack cost will only filter it.
+		const int tuFlood = std::max(tuMax, unit->getTimeUnits());
+		const int energyFlood = std::max(energyMax, unit->getEnergy());
+		field.set(unit, _unit, _movementType, tuFlood, energyFlood, _reachableCacheVersion, knownUnits, floodReachable(unit, tuFlood, energyFlood));
+	}
+	return field;
+}
+
+/**
+ * Gets hash of units that isBlocked treats as obstacles based on knowledge of current unit.
+ * Visibility and spotted units change on FOV updates without map version change.
+ * @return Hash of known units.
+ */
+Uint32 Pathfinding::getKnownUnitsHash() const
+{
+	Uint32 hash = 2166136261u;
+	auto add = [&](const BattleUnit *unit)
+	{
+		hash = (hash ^ (Uint32)unit->getId()) * 16777619u;
+	};
+	if (_unit && _unit->getFaction() == FACTION_PLAYER)
+	{
+		for (const BattleUnit *unit : *_save->getUnits())
+		{
+			if (unit->getFaction() != FACTION_PLAYER && unit->getVisible())
+			{
+				add(unit);
+			}
+		}
+	}
+	else if (_unit && _unit->getFaction() == FACTION_HOSTILE)
+	{
+		for (const BattleUnit *unit : _unit->getUnitsSpottedThisTurn())
+		{
+			add(unit);
+		}
+	}
+	return hash;
+}
+
+/**
+ * Locates all tiles reachable to @a *unit with a TU cost no more than @a tuMax.
+ * Uses Dijkstra's algorithm.
+ * @param unit Pointer to the unit.
+ * @param tuMax The maximum TU cost of the path to each tile.
+ * @param energyMax The maximum energy cost of the path to each tile.
+ * @return An array of reachable tiles, sorted in ascending order of cost. The first tile is the start location.
+ */
+std::vector<PathfindingReachable::Entry> Pathfinding::floodReachable(BattleUnit *unit, int tuMax, int energyMax)
+{
+	const Position start = unit->getPosition();
+	startSearch();
+	PathfindingNode *startNode = getSearchNode(start);
 	startNode->connect(0, 0, 0);
-	PathfindingOpenSet unvisited;
+	PathfindingOpenSet &unvisited = _openSet;
 	unvisited.push(startNode);
 	std::vector<PathfindingNode*> reachable;
 	while (!unvisited.empty())
@@ -1173,7 +1272,7 @@ std::vector<int> Pathfinding::findReachable(BattleUnit *unit, const BattleAction
 			if (currentNode->getTUCost(false) + tuCost > tuMax ||
 				(currentNode->getTUCost(false) + tuCost) / 2 > energyMax) // Run out of TUs/Energy
 				continue;
-			PathfindingNode *nextNode = getNode(nextPos);
+			PathfindingNode *nextNode = getSearchNode(nextPos);
 			if (nextNode->isChecked()) // Our algorithm means this node is already at minimum cost.
 				continue;
 			int totalTuCost = currentNode->getTUCost(false) + tuCost;
@@ -1188,11 +1287,11 @@ std::vector<int> Pathfinding::findReachable(BattleUnit *unit, const BattleAction
 		reachable.push_back(currentNode);
 	}
 	std::sort(reachable.begin(), reachable.end(), MinNodeCosts());
-	std::vector<int> tiles;
+	std::vector<PathfindingReachable::Entry> tiles;
 	tiles.reserve(reachable.size());
 	for (std::vector<PathfindingNode*>::const_iterator it = reachable.begin(); it != reachable.end(); ++it)
 	{
-		tiles.push_back(_save->getTileIndex((*it)->getPosition()));
+		tiles.push_back({ _save->getTileIndex((*it)->getPosition()), (*it)->getTUCost(false), (*it)->getPrevDir() });
 	}
 	return tiles;
 }
@@ -18,8 +18,11 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <vector>
+#include <map>
 #include "Position.h"
 #include "PathfindingNode.h"
+#include "PathfindingOpenSet.h"
+#include "PathfindingReachable.h"
 #include "../Mod/MapData.h"
 
 namespace OpenXcom
@@ -43,6 +46,11 @@ private:
 
 	SavedBattleGame *_save;
 	std::vector<PathfindingNode> _nodes;
+	PathfindingOpenSet _openSet;
+	Uint32 _searchGeneration;
+	/// Reachable tiles for each unit, valid only for current map version.
+	std::map<int, PathfindingReachable> _reachableCache;
+	Uint32 _reachableCacheVersion;
 	int _size;
 	BattleUnit *_unit;
 	bool _pathPreviewed;
@@ -52,12 +60,20 @@ private:
 	MovementType _movementType;
 	/// Gets the node at certain position.
 	PathfindingNode *getNode(Position pos);
+	/// Gets the node at certain position, prepared for current search.
+	PathfindingNode *getSearchNode(Position pos);
+	/// Invalidates all nodes and the open set before new search.
+	void startSearch();
 	/// Determines whether a tile blocks a certain movementType.
 	bool isBlocked(Tile *tile, const int part, BattleUnit *missileTarget, int bigWallExclusion = -1) const;
 	/// Tries to find a straight line path between two positions.
 	bool bresenhamPath(Position origin, Position target, BattleUnit *missileTarget, bool sneak = false, int maxTUCost = 1000);
 	/// Tries to find a path between two positions.
 	bool aStarPath(Position origin, Position target, BattleUnit *missileTarget, bool sneak = false, int maxTUCost = 1000);
+	/// Floods the map from unit position.
+	std::vector<PathfindingReachable::Entry> floodReachable(BattleUnit *unit, int tuMax, int energyMax);
+	/// Gets hash of enemy units that current unit knows about, they block its path.
+	Uint32 getKnownUnitsHash() const;
 	/// Determines whether a unit can fall down from this tile.
 	bool canFallDown(Tile *destinationTile) const;
 	/// Determines whether a unit can fall down from this tile.
@@ -131,6 +147,8 @@ public:
 	void setUnit(BattleUnit *unit);
 	/// Gets all reachable tiles, based on cost.
 	std::vector<int> findReachable(BattleUnit *unit, const BattleActionCost &cost);
+	/// Gets reachability field of unit, cached until map change.
+	const PathfindingReachable &getReachable(BattleUnit *unit, int tuMax, int energyMax);
 	/// Gets _totalTUCost; finds out whether we can hike somewhere in this turn or not.
 	int getTotalTUCost() const { return _totalTUCost; }
 	/// Gets the path preview setting.
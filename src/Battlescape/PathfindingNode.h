@@ -23,7 +23,6 @@ namespace OpenXcom
 {
 
 class PathfindingOpenSet;
-struct OpenSetEntry;
 
 /**
  * A class that holds pathfinding info for a certain node on the map.
@@ -32,14 +31,16 @@ class PathfindingNode
 {
 private:
 	Position _pos;
+	/// Search that last used this node, if different then all other fields are stale.
+	Uint32 _generation;
 	bool _checked;
 	int _tuCost;
 	PathfindingNode* _prevNode;
 	int _prevDir;
 	/// Approximate cost to reach goal position.
 	int _tuGuess;
-	// Invasive field needed by PathfindingOpenSet
-	OpenSetEntry *_openentry;
+	// Invasive field needed by PathfindingOpenSet, cost of the valid entry or -1
+	int _openCost;
 	friend class PathfindingOpenSet;
 public:
 	/// Creates a new PathfindingNode class.
@@ -49,7 +50,9 @@ public:
 	/// Gets the node position.
 	Position getPosition() const;
 	/// Resets the node.
-	void reset();
+	void reset(Uint32 generation);
+	/// Resets the node if it was last used by different search.
+	void prepare(Uint32 generation) { if (_generation != generation) reset(generation); }
 	/// Is checked?
 	bool isChecked() const;
 	/// Marks the node as checked.
@@ -61,7 +64,7 @@ public:
 	/// Gets the previous walking direction.
 	int getPrevDir() const;
 	/// Is this node already in a PathfindingOpenSet?
-	bool inOpenSet() const { return (_openentry != 0); }
+	bool inOpenSet() const { return (_openCost != -1); }
 	/// Gets the approximate cost to reach the target position.
 	int getTUGuess() const { return _tuGuess; }
 
@@ -17,6 +17,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <assert.h>
+#include <algorithm>
 #include "PathfindingOpenSet.h"
 #include "PathfindingNode.h"
 
@@ -24,29 +25,21 @@ namespace OpenXcom
 {
 
 /**
- * Cleans up all the entries still in set.
+ * Removes all entries from the set. Buckets keep their memory for the next search.
+ * Nodes are not touched, they are invalidated by the search generation.
  */
-PathfindingOpenSet::~PathfindingOpenSet()
+void PathfindingOpenSet::clear()
 {
-	while (!_queue.empty())
+	if (!_buckets.empty())
 	{
-		OpenSetEntry *entry = _queue.top();
-		_queue.pop();
-		delete entry;
-	}
-}
-
-/**
- * Keeps removing all discarded entries that have come to the top of the queue.
- */
-void PathfindingOpenSet::removeDiscarded()
-{
-	while (!_queue.empty() && !_queue.top()->_node)
-	{
-		OpenSetEntry *entry = _queue.top();
-		_queue.pop();
-		delete entry;
+		for (size_t i = _minBucket; i <= _maxBucket; ++i)
+		{
+			_buckets[i].clear();
+		}
 	}
+	_minBucket = 0;
+	_maxBucket = 0;
+	_count = 0;
 }
 
 /**
@@ -57,15 +50,25 @@ void PathfindingOpenSet::removeDiscarded()
 PathfindingNode *PathfindingOpenSet::pop()
 {
 	assert(!empty());
-	OpenSetEntry *entry = _queue.top();
-	PathfindingNode *nd = entry->_node;
-	_queue.pop();
-	delete entry;
-	nd->_openentry = 0;
-
-	// Discarded entries might be visible now.
-	removeDiscarded();
-	return nd;
+	while (true)
+	{
+		auto& bucket = _buckets[_minBucket];
+		if (bucket.empty())
+		{
+			++_minBucket;
+			continue;
+		}
+		PathfindingNode *nd = bucket.back();
+		bucket.pop_back();
+		// Discarded entries, node was pushed again with better cost.
+		if (nd->_openCost != (int)_minBucket)
+		{
+			continue;
+		}
+		nd->_openCost = -1;
+		--_count;
+		return nd;
+	}
 }
 
 /**
@@ -76,13 +79,20 @@ PathfindingNode *PathfindingOpenSet::pop()
  */
 void PathfindingOpenSet::push(PathfindingNode *node)
 {
-	OpenSetEntry *entry = new OpenSetEntry;
-	entry->_node = node;
-	entry->_cost = node->getTUCost(false) + node->getTUGuess();
-	if (node->_openentry)
-		node->_openentry->_node = 0;
-	node->_openentry = entry;
-	_queue.push(entry);
+	const int cost = std::max(node->getTUCost(false) + node->getTUGuess(), 0);
+	const size_t index = cost;
+	if (index >= _buckets.size())
+	{
+		_buckets.resize(index + 1);
+	}
+	if (!node->inOpenSet())
+	{
+		++_count;
+	}
+	node->_openCost = cost;
+	_buckets[index].push_back(node);
+	_minBucket = std::min(_minBucket, index);
+	_maxBucket = std::max(_maxBucket, index);
 }
 
 
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include "PathfindingReachable.h"
+#include "../Savegame/BattleUnit.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Finds entry for a tile using binary search.
+ * @param tileIndex Index of tile.
+ * @return Entry or null if tile is not reachable.
+ */
+const PathfindingReachable::Entry *PathfindingReachable::find(int tileIndex) const
+{
+	auto it = std::lower_bound(_byTile.begin(), _byTile.end(), tileIndex, [](const Entry &e, int i){ return e.tileIndex < i; });
+	if (it != _byTile.end() && it->tileIndex == tileIndex)
+	{
+		return &*it;
+	}
+	return nullptr;
+}
+
+/**
+ * Checks if this field was calculated for the same unit, position and movement,
+ * with at least the same budget, after last map change and with the same known units.
+ * @param unit Unit that moves.
+ * @param pathUnit Unit currently set in pathfinding.
+ * @param movementType Current movement type of pathfinding.
+ * @param tuMax Maximum TU cost.
+ * @param energyMax Maximum energy cost.
+ * @param mapVersion Current map version.
+ * @param knownUnits Hash of units that block path of pathUnit.
+ * @return True if query can be answered by this field.
+ */
+bool PathfindingReachable::isValid(const BattleUnit *unit, const BattleUnit *pathUnit, MovementType movementType, int tuMax, int energyMax, Uint32 mapVersion, Uint32 knownUnits) const
+{
+	return _unit == unit
+		&& _pathUnit == pathUnit
+		&& _start == unit->getPosition()
+		&& _movementType == movementType
+		&& _mapVersion == mapVersion
+		&& _knownUnits == knownUnits
+		&& tuMax <= _tuMax
+		&& energyMax <= _energyMax;
+}
+
+/**
+ * Replaces the field with new flood result.
+ * @param unit Unit that moves.
+ * @param pathUnit Unit currently set in pathfinding.
+ * @param movementType Current movement type of pathfinding.
+ * @param tuMax Maximum TU cost used by flood.
+ * @param energyMax Maximum energy cost used by flood.
+ * @param mapVersion Current map version.
+ * @param knownUnits Hash of units that block path of pathUnit.
+ * @param byCost Tiles reached by flood, sorted by cost.
+ */
+void PathfindingReachable::set(const BattleUnit *unit, const BattleUnit *pathUnit, MovementType movementType, int tuMax, int energyMax, Uint32 mapVersion, Uint32 knownUnits, std::vector<Entry> &&byCost)
+{
+	_unit = unit;
+	_pathUnit = pathUnit;
+	_start = unit->getPosition();
+	_movementType = movementType;
+	_tuMax = tuMax;
+	_energyMax = energyMax;
+	_mapVersion = mapVersion;
+	_knownUnits = knownUnits;
+	_byCost = std::move(byCost);
+	_byTile = _byCost;
+	std::sort(_byTile.begin(), _byTile.end(), [](const Entry &a, const Entry &b){ return a.tileIndex < b.tileIndex; });
+}
+
+/**
+ * Gets the tiles that can be reached with given budget.
+ * Flood prunes paths by cost so a smaller budget is only a filter of bigger one.
+ * @param tuMax Maximum TU cost.
+ * @param energyMax Maximum energy cost.
+ * @return An array of reachable tiles, sorted in ascending order of cost. The first tile is the start location.
+ */
+std::vector<int> PathfindingReachable::getTiles(int tuMax, int energyMax) const
+{
+	std::vector<int> tiles;
+	tiles.reserve(_byCost.size());
+	for (auto& e : _byCost)
+	{
+		if (!tiles.empty() && (e.tuCost > tuMax || e.tuCost / 2 > energyMax))
+		{
+			continue;
+		}
+		tiles.push_back(e.tileIndex);
+	}
+	return tiles;
+}
+
+/**
+ * Gets the TU cost to reach a tile.
+ * @param tileIndex Index of tile.
+ * @return TU cost or -1.
+ */
+int PathfindingReachable::getTUCost(int tileIndex) const
+{
+	auto e = find(tileIndex);
+	return e ? e->tuCost : -1;
+}
+
+/**
+ * Gets the direction that was used to enter a tile.
+ * @param tileIndex Index of tile.
+ * @return Direction or -1.
+ */
+int PathfindingReachable::getPrevDir(int tileIndex) const
+{
+	auto e = find(tileIndex);
+	return e ? e->prevDir : -1;
+}
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <SDL_types.h>
+#include "Position.h"
+#include "../Mod/MapData.h"
+
+namespace OpenXcom
+{
+
+class BattleUnit;
+
+/**
+ * Result of the flood from unit position, all tiles it can reach with cost and direction.
+ * Calculated once for unit and budget, reused by queries with lower budget until map change.
+ */
+class PathfindingReachable
+{
+public:
+	/**
+	 * One tile reached by flood.
+	 */
+	struct Entry
+	{
+		int tileIndex;
+		int tuCost;
+		int prevDir;
+	};
+
+private:
+	const BattleUnit *_unit = nullptr;
+	const BattleUnit *_pathUnit = nullptr;
+	Position _start;
+	MovementType _movementType = MT_WALK;
+	int _tuMax = 0;
+	int _energyMax = 0;
+	Uint32 _mapVersion = 0;
+	Uint32 _knownUnits = 0;
+	/// Tiles sorted by cost, first one is start location.
+	std::vector<Entry> _byCost;
+	/// Same tiles sorted by tile index.
+	std::vector<Entry> _byTile;
+
+	/// Finds entry for tile.
+	const Entry *find(int tileIndex) const;
+
+public:
+	/// Checks if this field can answer query for unit in its current state.
+	bool isValid(const BattleUnit *unit, const BattleUnit *pathUnit, MovementType movementType, int tuMax, int energyMax, Uint32 mapVersion, Uint32 knownUnits) const;
+	/// Replaces the field with new flood result.
+	void set(const BattleUnit *unit, const BattleUnit *pathUnit, MovementType movementType, int tuMax, int energyMax, Uint32 mapVersion, Uint32 knownUnits, std::vector<Entry> &&byCost);
+	/// Gets the indexes of tiles reachable with given budget, sorted by cost.
+	std::vector<int> getTiles(int tuMax, int energyMax) const;
+	/// Gets the TU cost to reach tile, or -1 if it is not reachable.
+	int getTUCost(int tileIndex) const;
+	/// Gets the direction from the previous tile on path, or -1 if tile is not reachable.
+	int getPrevDir(int tileIndex) const;
+};
+
+}
@@ -19,6 +19,7 @@
 #include <assert.h>
 #include <climits>
 #include <set>
+#include <unordered_set>
 #include "TileEngine.h"
 #include <SDL.h>
 #include "AIModule.h"
@@ -45,6 +46,8 @@
 #include "Pathfinding.h"
 #include "../Engine/Game.h"
 #include "../Engine/Options.h"
+#include "../Engine/ThreadPool.h"
+#include "../Engine/FrameTrace.h"
 #include "ProjectileFlyBState.h"
 #include "MeleeAttackBState.h"
 #include "../fmath.h"
@@ -233,6 +236,55 @@ void iterateTiles(SavedBattleGame* save, MapSubset gs, TileFunc func)
 	}
 }
 
+/**
+ * Iterate over rows of tiles in map subset, each row is continuous range of tile indexes.
+ * @param save Map data.
+ * @param gs Subset of map.
+ * @param func Call back taking index of first tile and length of row.
+ */
+template<typename RowFunc>
+void iterateTileRows(SavedBattleGame* save, MapSubset gs, RowFunc func)
+{
+	const auto totalSizeX = save->getMapSizeX();
+	const auto totalSizeY = save->getMapSizeY();
+	const auto totalSizeZ = save->getMapSizeZ();
+
+	gs = MapSubset::intersection(gs, MapSubset{ totalSizeX, totalSizeY });
+	if (gs)
+	{
+		for (int z = 0; z < totalSizeZ; ++z)
+		{
+			auto rowStart = save->getTileIndex(Position{ gs.beg_x, gs.beg_y, z });
+			for (auto stepsY = gs.size_y(); stepsY != 0; --stepsY, rowStart += totalSizeX)
+			{
+				func(rowStart, gs.size_x());
+			}
+		}
+	}
+}
+
+/**
+ * Reset light layers in map subset, starting from given layer.
+ * @param save Map data.
+ * @param gs Subset of map.
+ * @param layer First layer to reset.
+ */
+void resetLightRows(SavedBattleGame* save, MapSubset gs, LightLayers layer)
+{
+	auto& hot = save->getTileHotData();
+	iterateTileRows(
+		save,
+		gs,
+		[&](int index, int size)
+		{
+			for (int l = layer; l < LL_MAX; ++l)
+			{
+				std::fill_n(hot.light[l].begin() + index, size, 0);
+			}
+		}
+	);
+}
+
 /**
  * Generate square subset of map using position and radius.
  * @param position Starting position.
@@ -249,6 +301,84 @@ MapSubset mapAreaExpand(MapSubset gs, int radius)
 	return { std::make_pair(gs.beg_x - radius, gs.end_x + radius), std::make_pair(gs.beg_y - radius, gs.end_y + radius) };
 }
 
+/// Step of elevation of explosion rays, in degrees.
+constexpr int ExplosionRayElevationStep = 5;
+/// Step of azimuth of explosion rays, in degrees, every 3 degrees makes sure we cover all tiles in a circle.
+constexpr int ExplosionRayAzimuthStep = 3;
+/// Number of azimuths for each elevation.
+constexpr int ExplosionRayAzimuthCount = 360 / ExplosionRayAzimuthStep + 1;
+/// Number of all rays of explosion.
+constexpr int ExplosionRayCount = (180 / ExplosionRayElevationStep + 1) * ExplosionRayAzimuthCount;
+
+/**
+ * One step of explosion ray, offset from center and how ray moved from previous step.
+ */
+struct ExplosionRayStep
+{
+	Sint16 x, y, z;
+	/// Ray changed level in this step.
+	bool vertical;
+	/// Ray moved diagonally in this step.
+	bool diagonal;
+};
+
+/**
+ * Gets steps of all explosion rays of given radius.
+ * Rays are ordered by elevation and then by azimuth, each one have exactly `radius` steps.
+ * @param radius Maximum radius of explosion.
+ * @return Steps of all rays, step `l` of ray `r` is at `r * radius + l - 1`.
+ */
+const std::vector<ExplosionRayStep>& getExplosionRays(int radius)
+{
+	static std::map<int, std::vector<ExplosionRayStep>> cache;
+
+	auto it = cache.find(radius);
+	if (it != cache.end())
+	{
+		return it->second;
+	}
+
+	auto& steps = cache[radius];
+	if (radius <= 0)
+	{
+		return steps;
+	}
+	steps.reserve(ExplosionRayCount * radius);
+	for (int fi = -90; fi <= 90; fi += ExplosionRayElevationStep)
+	{
+		for (int te = 0; te <= 360; te += ExplosionRayAzimuthStep)
+		{
+			double cos_te = cos(Deg2Rad(te));
+			double sin_te = sin(Deg2Rad(te));
+			double sin_fi = sin(Deg2Rad(fi));
+			double cos_fi = cos(Deg2Rad(fi));
+
+			Position prev = Position(0, 0, 0);
+			for (int l = 1; l <= radius; ++l)
+			{
+				Position curr = Position(
+					int(floor(0.5 + l * sin_te * cos_fi)),
+					int(floor(0.5 + l * cos_te * cos_fi)),
+					int(floor(0.5 + l * sin_fi))
+				);
+				int dir;
+				Pathfinding::vectorToDirection(prev - curr, dir);
+
+				ExplosionRayStep s;
+				s.x = curr.x;
+				s.y = curr.y;
+				s.z = curr.z;
+				s.vertical = prev.z != curr.z;
+				s.diagonal = dir != -1 && dir % 2;
+				steps.push_back(s);
+
+				prev = curr;
+			}
+		}
+	}
+	return steps;
+}
+
 } // namespace
 
 constexpr int TileEngine::heightFromCenter[11];
@@ -266,14 +396,13 @@ constexpr Position TileEngine::voxelTileCenter;
  * @param maxDarknessToSeeUnits Threshold of darkness for LoS calculation.
  */
 TileEngine::TileEngine(SavedBattleGame *save, Mod *mod) :
-	_save(save), _voxelData(mod->getVoxelData()), _inventorySlotGround(mod->getInventoryGround()), _personalLighting(true), _cacheTile(0), _cacheTileBelow(0),
+	_save(save), _voxelData(mod->getVoxelData()), _inventorySlotGround(mod->getInventoryGround()), _personalLighting(true),
 	_maxViewDistance(mod->getMaxViewDistance()), _maxViewDistanceSq(_maxViewDistance * _maxViewDistance),
 	_maxVoxelViewDistance(_maxViewDistance * 16), _maxDarknessToSeeUnits(mod->getMaxDarknessToSeeUnits()),
 	_maxStaticLightDistance(mod->getMaxStaticLightDistance()), _maxDynamicLightDistance(mod->getMaxDynamicLightDistance()),
 	_enhancedLighting(mod->getEnhancedLighting())
 {
 	_blockVisibility.resize(save->getMapSizeXYZ());
-	_cacheTilePos = invalid;
 }
 
 /**
@@ -448,6 +577,9 @@ void TileEngine::calculateUnitLighting(MapSubset gs)
 
 void TileEngine::calculateLighting(LightLayers layer, Position position, int eventRadius, bool terrianChanged)
 {
+	FrameTraceScope trace("TileEngine::calculateLighting");
+	++_lightingPass;
+
 	auto gsDynamic = MapSubset{ _save->getMapSizeX(), _save->getMapSizeY() };
 	auto gsStatic = gsDynamic;
 
@@ -459,6 +591,9 @@ void TileEngine::calculateLighting(LightLayers layer, Position position, int eve
 
 	if (terrianChanged)
 	{
+		// cached light around changed terrain is no longer valid
+		invalidateLightContributions(mapArea(position, position != invalid ? eventRadius + 1 : 1000));
+
 		iterateTiles(
 			_save,
 			mapArea(position, position != invalid ? eventRadius + 1 : 1000),
@@ -519,39 +654,50 @@ void TileEngine::calculateLighting(LightLayers layer, Position position, int eve
 
 	if (layer <= LL_FIRE)
 	{
-		iterateTiles(
-			_save,
-			gsStatic,
-			[&](Tile* tile)
-			{
-				tile->resetLightMulti(layer);
-			}
-		);
+		resetLightRows(_save, gsStatic, layer);
 	}
 
-	iterateTiles(
-		_save,
-		gsDynamic,
-		[&](Tile* tile)
-		{
-			tile->resetLightMulti(std::max(layer, LL_ITEMS));
-		}
-	);
+	resetLightRows(_save, gsDynamic, std::max(layer, LL_ITEMS));
 
 	if (layer <= LL_AMBIENT) calculateSunShading(gsStatic);
 	if (layer <= LL_FIRE) calculateTerrainBackground(gsStatic);
 	if (layer <= LL_ITEMS) calculateTerrainItems(gsDynamic);
 	if (layer <= LL_UNITS) calculateUnitLighting(gsDynamic);
+
+	// forget sources that were not used recently, like old positions of units,
+	// only layers recalculated in this pass know which of their sources are still used
+	for (int l = std::max((int)layer, (int)LL_FIRE); l < LL_MAX; ++l)
+	{
+		auto begin = _lightContributions.lower_bound(LightSourceKey{ l, -1, -1 });
+		auto end = _lightContributions.lower_bound(LightSourceKey{ l + 1, -1, -1 });
+		if ((size_t)std::distance(begin, end) <= MaxLightContributions)
+		{
+			continue;
+		}
+		for (auto it = begin; it != end; )
+		{
+			if (it->second.lastUsed != _lightingPass)
+			{
+				it = _lightContributions.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
 }
 
 /**
  * Adds circular light pattern starting from center and losing power with distance travelled.
+ * Enhanced lighting reuses light calculated earlier for same source, if terrain around it did not change.
+ * @param gs Part of map that is updated.
  * @param center Center.
  * @param power Power.
  * @param layer Light is separated in 4 layers: Ambient, Tiles, Items, Units.
  */
 void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers layer)
-	{
+{
 	if (power <= 0)
 	{
 		return;
@@ -560,37 +706,129 @@ void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers
 	const auto fire = layer == LL_FIRE;
 	const auto items = layer == LL_ITEMS;
 	const auto units = layer == LL_UNITS;
+	const auto clasicLighting = !(getEnhancedLighting() & ((fire ? 1 : 0) | (items ? 2 : 0) | (units ? 4 : 0)));
+
+	if (clasicLighting)
+	{
+		iterateTiles(
+			_save,
+			MapSubset::intersection(gs, mapArea(center, power - 1)),
+			[&](Tile* tile)
+			{
+				const auto distance = (int)Round(Position::distance(tile->getPosition(), center));
+				const auto currLight = power - distance;
+				if (currLight > tile->getLightMulti(layer))
+				{
+					tile->addLight(currLight, layer);
+				}
+			}
+		);
+		return;
+	}
+
+	const auto& contribution = getLightContribution(center, power, layer);
+	for (const auto& lit : contribution.tiles)
+	{
+		const auto& target = lit.position;
+		if (target.x < gs.beg_x || target.x >= gs.end_x || target.y < gs.beg_y || target.y >= gs.end_y)
+		{
+			continue;
+		}
+		Tile *tile = _save->getTile(target);
+		const int targetLight = tile->getLightMulti(layer);
+		if (lit.light <= targetLight)
+		{
+			continue;
+		}
+		// ray that get weaker than light already on tile is cut off,
+		// light of ray only decrease so checking final value is enough.
+		const int lightA = lit.lightA >= targetLight ? lit.lightA : 0;
+		const int lightB = lit.lightB >= targetLight ? lit.lightB : 0;
+		const int currLight = (lightA + lightB) / 2;
+		if (currLight > targetLight)
+		{
+			tile->addLight(currLight, layer);
+		}
+	}
+}
+
+/**
+ * Gets light that source gives to tiles around it, calculating it if it is not cached yet.
+ * @param center Center.
+ * @param power Power.
+ * @param layer Light layer.
+ * @return Light of all tiles lit by this source.
+ */
+const TileEngine::LightContribution &TileEngine::getLightContribution(Position center, int power, LightLayers layer)
+{
+	auto& contribution = _lightContributions[LightSourceKey{ layer, _save->getTileIndex(center), power }];
+	if (contribution.lastUsed == 0)
+	{
+		contribution.center = center;
+		contribution.power = power;
+		calculateLightContribution(center, power, layer, contribution.tiles);
+	}
+	contribution.lastUsed = _lightingPass;
+	return contribution;
+}
+
+/**
+ * Removes cached light of all sources that can reach given part of map.
+ * @param gs Part of map that changed.
+ */
+void TileEngine::invalidateLightContributions(MapSubset gs)
+{
+	for (auto it = _lightContributions.begin(); it != _lightContributions.end(); )
+	{
+		if (MapSubset::intersection(gs, mapArea(it->second.center, it->second.power - 1)))
+		{
+			it = _lightContributions.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+/**
+ * Calculates enhanced light of one source, independent of any other light on map.
+ * Rays are not cut by light already on tile, addLight does it when applying the result.
+ * @param center Center.
+ * @param power Power.
+ * @param layer Light layer.
+ * @param tiles Result, lit tiles and light of both rays that reach them.
+ */
+void TileEngine::calculateLightContribution(Position center, int power, LightLayers layer, std::vector<LitTile> &tiles)
+{
+	tiles.clear();
+
+	const auto fire = layer == LL_FIRE;
+	const auto items = layer == LL_ITEMS;
 	const auto ground = items || fire;
 	const auto tileHeight = _save->getTile(center)->getTerrainLevel();
 	const auto divide = (fire ? 8 : 4);
 	const auto accuracy = TileEngine::voxelTileSize / divide;
 	const auto offsetCenter = (accuracy / 2 + Position(-1, -1, (ground ? 0 : accuracy.z/4) - tileHeight * accuracy.z / 24));
 	const auto offsetTarget = (accuracy / 2 + Position(-1, -1, 0));
-	const auto clasicLighting = !(getEnhancedLighting() & ((fire ? 1 : 0) | (items ? 2 : 0) | (units ? 4 : 0)));
 	const auto topTargetVoxel = static_cast<Sint16>(_save->getMapSizeZ() * accuracy.z - 1);
 	const auto topCenterVoxel = static_cast<Sint16>((_blockVisibility[_save->getTileIndex(center)].blockUp ? (center.z + 1) : _save->getMapSizeZ()) * accuracy.z - 1);
 	const auto maxFirePower = std::min(15, getMaxStaticLightDistance() - 1);
 
 	iterateTiles(
 		_save,
-		MapSubset::intersection(gs, mapArea(center, power - 1)),
+		mapArea(center, power - 1),
 		[&](Tile* tile)
 		{
 			const auto target = tile->getPosition();
 			const auto diff = target - center;
 			const auto distance = (int)Round(Position::distance(target, center));
-			const auto targetLight = tile->getLightMulti(layer);
 			auto currLight = power - distance;
 
-			if (currLight <= targetLight)
+			if (currLight <= 0)
 			{
 				return;
 			}
-			if (clasicLighting)
-			{
-				tile->addLight(currLight, layer);
-				return;
-			}
 
 			Position startVoxel = (center * accuracy) + offsetCenter;
 			Position endVoxel = (target * accuracy) + offsetTarget + Position(0, 0, std::max(0, (_blockVisibility[_save->getTileIndex(target)].height - 1) / (2 * divide)));
@@ -683,7 +921,7 @@ void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers
 				}
 				++steps;
 				lastPoint = point;
-				if (result || light < targetLight)
+				if (result || light < 0)
 				{
 					light = 0;
 					return true;
@@ -704,10 +942,9 @@ void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers
 				}
 			);
 
-			currLight = (lightA + lightB) / 2;
-			if (currLight > targetLight)
+			if ((lightA + lightB) / 2 > 0)
 			{
-				tile->addLight(currLight, layer);
+				tiles.push_back(LitTile{ target, (Uint8)currLight, (Uint8)lightA, (Uint8)lightB });
 			}
 		}
 	);
@@ -719,17 +956,18 @@ void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers
  * the observer based on the event affecting visibility at the event itself and beyond it in its direction.
  * Imagines a circle around the event of eventRadius, calculates its tangents, and places points at the circle's tangent
  * intersections for later bounds checking.
+ * @param sector Sector to setup.
  * @param observerPos Position of the observer of this event.
  * @param eventPos The centre of the event. Ie a moving unit's position, centre of explosion, a single destroyed tile, etc.
  * @param eventRadius Radius big enough to fully envelop the event. Ie for a single tile change, set radius to 1.
  * @return true if area is unlimited.
  *
 */
-bool TileEngine::setupEventVisibilitySector(const Position &observerPos, const Position &eventPos, const int &eventRadius)
+bool TileEngine::setupEventVisibilitySector(EventVisibilitySector &sector, const Position &observerPos, const Position &eventPos, const int &eventRadius) const
 {
 	if (eventRadius == 0 || eventPos == Position(-1, -1, -1) || Position::distance2dSq(observerPos, eventPos) <= eventRadius * eventRadius)
 	{
-		_eventVisibilityObserverPos = Position{ -1, -1, -1 };
+		sector.observerPos = Position{ -1, -1, -1 };
 		return true;
 	}
 	else
@@ -743,11 +981,11 @@ bool TileEngine::setupEventVisibilitySector(const Position &observerPos, const P
 		float t1 = b - a;
 		float t2 = b + a;
 		//Define the points where the lines tangent to the circle intersect it. Note: resulting positions are relative to observer, not in direct tile space.
-		_eventVisibilitySectorL.x = roundf(eventPos.x + eventRadius * sinf(t1)) - observerPos.x;
-		_eventVisibilitySectorL.y = roundf(eventPos.y - eventRadius * cosf(t1)) - observerPos.y;
-		_eventVisibilitySectorR.x = roundf(eventPos.x - eventRadius * sinf(t2)) - observerPos.x;
-		_eventVisibilitySectorR.y = roundf(eventPos.y + eventRadius * cosf(t2)) - observerPos.y;
-		_eventVisibilityObserverPos = observerPos;
+		sector.left.x = roundf(eventPos.x + eventRadius * sinf(t1)) - observerPos.x;
+		sector.left.y = roundf(eventPos.y - eventRadius * cosf(t1)) - observerPos.y;
+		sector.right.x = roundf(eventPos.x - eventRadius * sinf(t2)) - observerPos.x;
+		sector.right.y = roundf(eventPos.y + eventRadius * cosf(t2)) - observerPos.y;
+		sector.observerPos = observerPos;
 		return false;
 	}
 }
@@ -755,17 +993,18 @@ bool TileEngine::setupEventVisibilitySector(const Position &observerPos, const P
 /**
  * Checks whether toCheck is within a previously setup eventVisibilitySector. See setupEventVisibilitySector(...).
  * May be used to rapidly reduce the search space when updating unit and tile visibility.
+ * @param sector The sector to check against.
  * @param toCheck The position to check.
  * @return true if within the circle sector.
  */
-inline bool TileEngine::inEventVisibilitySector(const Position &toCheck) const
+inline bool TileEngine::inEventVisibilitySector(const EventVisibilitySector &sector, const Position &toCheck) const
 {
-	if (_eventVisibilityObserverPos != Position{ -1, -1, -1 })
+	if (sector.observerPos != Position{ -1, -1, -1 })
 	{
-		Position posDiff = toCheck - _eventVisibilityObserverPos;
+		Position posDiff = toCheck - sector.observerPos;
 		//Is toCheck within the arc as defined by the two tangent points?
-		return (!(-_eventVisibilitySectorL.x * posDiff.y + _eventVisibilitySectorL.y * posDiff.x > 0) &&
-			(-_eventVisibilitySectorR.x * posDiff.y + _eventVisibilitySectorR.y * posDiff.x > 0));
+		return (!(-sector.left.x * posDiff.y + sector.left.y * posDiff.x > 0) &&
+			(-sector.right.x * posDiff.y + sector.right.y * posDiff.x > 0));
 	}
 	else
 	{
@@ -782,21 +1021,52 @@ inline bool TileEngine::inEventVisibilitySector(const Position &toCheck) const
 */
 bool TileEngine::calculateUnitsInFOV(BattleUnit* unit, const Position eventPos, const int eventRadius)
 {
-	size_t oldNumVisibleUnits = unit->getUnitsSpottedThisTurn().size();
-	bool useTurretDirection = false;
-	if (Options::strafe && (unit->getTurretType() > -1)) {
-		useTurretDirection = true;
+	FovUpdate update;
+	if (prepareUnitsInFOV(unit, eventPos, eventRadius, update))
+	{
+		findUnitsInFOV(unit, update, _voxelCheckCache);
+		return applyUnitsInFOV(unit, update);
 	}
+	return false;
+}
 
+/**
+* Prepares update of visible units of a single soldier.
+* @param unit Unit to check line of sight of.
+* @param eventPos The centre of the event which necessitated the FOV update.
+* @param eventRadius The radius of a circle able to fully encompass the event, in tiles.
+* @param update Storage for calculation results.
+* @return True if findUnitsInFOV need to be called.
+*/
+bool TileEngine::prepareUnitsInFOV(BattleUnit *unit, const Position eventPos, const int eventRadius, FovUpdate &update)
+{
 	if (unit->isOut())
 		return false;
 
 	Position posSelf = unit->getPosition();
-	if (setupEventVisibilitySector(posSelf, eventPos, eventRadius))
+	if (setupEventVisibilitySector(update.sector, posSelf, eventPos, eventRadius))
 	{
 		//Asked to do a full check. Or the event is overlapping our tile. Better check everything.
 		unit->clearVisibleUnits();
 	}
+	return true;
+}
+
+/**
+* Finds units visible by a single soldier.
+* Only visibility lists of this soldier are changed, everything else is stored in update for applyUnitsInFOV.
+* This mean it can be called by worker thread as long every thread have its own unit and voxel cache.
+* @param unit Unit to check line of sight of.
+* @param update Data prepared by prepareUnitsInFOV.
+* @param cache Voxel cache used by current thread.
+*/
+void TileEngine::findUnitsInFOV(BattleUnit *unit, FovUpdate &update, VoxelCheckCache &cache)
+{
+	size_t oldNumVisibleUnits = unit->getUnitsSpottedThisTurn().size();
+	bool useTurretDirection = false;
+	if (Options::strafe && (unit->getTurretType() > -1)) {
+		useTurretDirection = true;
+	}
 
 	//Loop through all units specified and figure out which ones we can actually see.
 	for (std::vector<BattleUnit*>::iterator i = _save->getUnits()->begin(); i != _save->getUnits()->end(); ++i)
@@ -811,33 +1081,26 @@ bool TileEngine::calculateUnitsInFOV(BattleUnit* unit, const Position eventPos,
 				{
 					Position posToCheck = posOther + Position(x, y, 0);
 					//If we can now find any unit within the arc defined by the event tangent points, its visibility may have been affected by the event.
-					if (inEventVisibilitySector(posToCheck))
+					if (inEventVisibilitySector(update.sector, posToCheck))
 					{
 						if (!unit->checkViewSector(posToCheck, useTurretDirection))
 						{
 							//Unit within arc, but not in view sector. If it just walked out we need to remove it.
 							unit->removeFromVisibleUnits((*i));
 						}
-						else if (visible(unit, _save->getTile(posToCheck))) // (distance is checked here)
+						else if (visible(cache, unit, _save->getTile(posToCheck))) // (distance is checked here)
 						{
 							//Unit (or part thereof) visible to one or more eyes of this unit.
 							if (unit->getFaction() == FACTION_PLAYER)
 							{
-								(*i)->setVisible(true);
+								update.seenUnits.push_back(*i);
 							}
 							if ((( (*i)->getFaction() == FACTION_HOSTILE && unit->getFaction() == FACTION_PLAYER )
 								|| ( (*i)->getFaction() != FACTION_HOSTILE && unit->getFaction() == FACTION_HOSTILE ))
 								&& !unit->hasVisibleUnit((*i)))
 							{
 								unit->addToVisibleUnits((*i));
-								unit->addToVisibleTiles((*i)->getTile());
-
-								if (unit->getFaction() == FACTION_HOSTILE && (*i)->getFaction() != FACTION_HOSTILE)
-								{
-									(*i)->setTurnsSinceSpotted(0);
-
-									(*i)->setTurnsLeftSpottedForSnipers(std::max(unit->getSpotterDuration(), (*i)->getTurnsLeftSpottedForSnipers())); // defaults to 0 = no information given to snipers
-								}
+								update.spottedUnits.push_back(*i);
 							}
 
 							x = y = sizeOther; //If a unit's tile is visible there's no need to check the others: break the loops.
@@ -855,11 +1118,33 @@ bool TileEngine::calculateUnitsInFOV(BattleUnit* unit, const Position eventPos,
 	// we only react when there are at least the same amount of visible units as before AND the checksum is different
 	// this way we stop if there are the same amount of visible units, but a different unit is seen
 	// or we stop if there are more visible units seen
-	if (unit->getUnitsSpottedThisTurn().size() > oldNumVisibleUnits && !unit->getVisibleUnits()->empty())
+	update.newUnitsSpotted = unit->getUnitsSpottedThisTurn().size() > oldNumVisibleUnits && !unit->getVisibleUnits()->empty();
+}
+
+/**
+* Applies changes to other units and tiles found by findUnitsInFOV.
+* @param unit Unit to check line of sight of.
+* @param update Data calculated by findUnitsInFOV.
+* @return True when new aliens are spotted.
+*/
+bool TileEngine::applyUnitsInFOV(BattleUnit *unit, FovUpdate &update)
+{
+	for (auto* bu : update.seenUnits)
 	{
-		return true;
+		bu->setVisible(true);
 	}
-	return false;
+	for (auto* bu : update.spottedUnits)
+	{
+		unit->addToVisibleTiles(bu->getTile());
+
+		if (unit->getFaction() == FACTION_HOSTILE && bu->getFaction() != FACTION_HOSTILE)
+		{
+			bu->setTurnsSinceSpotted(0);
+
+			bu->setTurnsLeftSpottedForSnipers(std::max(unit->getSpotterDuration(), bu->getTurnsLeftSpottedForSnipers())); // defaults to 0 = no information given to snipers
+		}
+	}
+	return update.newUnitsSpotted;
 }
 
 /**
@@ -871,35 +1156,68 @@ bool TileEngine::calculateUnitsInFOV(BattleUnit* unit, const Position eventPos,
 * @param eventRadius The radius of a circle able to fully encompass the event, in tiles. Hence: 1 for a single tile event.
 */
 void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos, const int eventRadius)
+{
+	FovUpdate update;
+	if (prepareTilesInFOV(unit, eventPos, eventRadius, update))
+	{
+		findTilesInFOV(unit, eventPos, eventRadius, update);
+		applyTilesInFOV(unit, update);
+	}
+}
+
+/**
+* Prepares update of visible tiles of a single soldier.
+* @param unit Unit to check line of sight of.
+* @param eventPos The centre of the event which necessitated the FOV update.
+* @param eventRadius The radius of a circle able to fully encompass the event, in tiles.
+* @param update Storage for calculation results.
+* @return True if findTilesInFOV need to be called.
+*/
+bool TileEngine::prepareTilesInFOV(BattleUnit *unit, const Position eventPos, const int eventRadius, FovUpdate &update)
 {
 	bool useTurretDirection = false;
-	bool skipNarrowArcTest = false;
-	int direction;
 	if (Options::strafe && (unit->getTurretType() > -1)) {
-		direction = unit->getTurretDirection();
 		useTurretDirection = true;
 	}
-	else
-	{
-		direction = unit->getDirection();
-	}
 	if (unit->getFaction() != FACTION_PLAYER || (eventRadius == 1 && !unit->checkViewSector(eventPos, useTurretDirection)))
 	{
 		//The event wasn't meant for us and/or visible for us.
-		return;
+		return false;
 	}
 	else if (unit->isOut())
 	{
 		unit->clearVisibleTiles();
-		return;
+		return false;
 	}
 	Position posSelf = unit->getPosition();
-	if (setupEventVisibilitySector(posSelf, eventPos, eventRadius))
+	if (setupEventVisibilitySector(update.sector, posSelf, eventPos, eventRadius))
 	{
 		//Asked to do a full check. Or unit within event. Should update all.
 		unit->clearVisibleTiles();
-		skipNarrowArcTest = true;
+		update.skipNarrowArcTest = true;
 	}
+	return true;
+}
+
+/**
+* Finds tiles visible by a single soldier, without changing any tile or unit.
+* @param unit Unit to check line of sight of.
+* @param eventPos The centre of the event which necessitated the FOV update.
+* @param eventRadius The radius of a circle able to fully encompass the event, in tiles.
+* @param update Data prepared by prepareTilesInFOV.
+*/
+void TileEngine::findTilesInFOV(BattleUnit *unit, const Position eventPos, const int eventRadius, FovUpdate &update)
+{
+	int direction;
+	if (Options::strafe && (unit->getTurretType() > -1)) {
+		direction = unit->getTurretDirection();
+	}
+	else
+	{
+		direction = unit->getDirection();
+	}
+	Position posSelf = unit->getPosition();
+	const bool skipNarrowArcTest = update.skipNarrowArcTest;
 
 	//Only recalculate bresenham lines to tiles that are at the event or further away.
 	const int distanceSqrMin = skipNarrowArcTest ? 0 : std::max(Position::distance2dSq(posSelf, eventPos) - eventRadius * eventRadius, 0);
@@ -907,6 +1225,7 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 	//Variables for finding the tiles to test based on the view direction.
 	Position posTest;
 	std::vector<Position> _trajectory;
+	std::unordered_set<Tile*> revealed;
 	bool swap = (direction == 0 || direction == 4);
 	const int signX[8] = { +1, +1, +1, +1, -1, -1, -1, -1 };
 	const int signY[8] = { -1, -1, -1, +1, +1, +1, -1, -1 };
@@ -941,7 +1260,7 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 				posTest.x = posSelf.x + signX[direction] * (swap ? y : x);
 				posTest.y = posSelf.y + signY[direction] * (swap ? x : y);
 				//Only continue if the column of tiles at (x,y) is within the narrow arc of interest (if enabled)
-				if (inEventVisibilitySector(posTest))
+				if (inEventVisibilitySector(update.sector, posTest))
 				{
 					for (int z = 0; z < _save->getMapSizeZ(); z++)
 					{
@@ -967,20 +1286,12 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 									//Reveal all tiles along line of vision. Note: needed due to width of bresenham stroke.
 									for (std::vector<Position>::iterator i = _trajectory.begin(); i != _trajectory.end(); ++i)
 									{
-										Position posVisited = (*i);
+										Tile *tileVisited = _save->getTile(*i);
 										//Add tiles to the visible list only once. BUT we still need to calculate the whole trajectory as
 										// this bresenham line's period might be different from the one that originally revealed the tile.
-										if (!unit->hasVisibleTile(_save->getTile(posVisited)))
+										if (!unit->hasVisibleTile(tileVisited) && revealed.insert(tileVisited).second)
 										{
-											unit->addToVisibleTiles(_save->getTile(posVisited));
-											_save->getTile(posVisited)->setVisible(+1);
-											_save->getTile(posVisited)->setDiscovered(true, O_FLOOR);
-
-											// walls to the east or south of a visible tile, we see that too
-											Tile* t = _save->getTile(Position(posVisited.x + 1, posVisited.y, posVisited.z));
-											if (t) t->setDiscovered(true, O_WESTWALL);
-											t = _save->getTile(Position(posVisited.x, posVisited.y + 1, posVisited.z));
-											if (t) t->setDiscovered(true, O_NORTHWALL);
+											update.revealedTiles.push_back(tileVisited);
 										}
 									}
 								}
@@ -993,6 +1304,29 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 	}
 }
 
+/**
+* Marks tiles found by findTilesInFOV as visible.
+* @param unit Unit to check line of sight of.
+* @param update Data calculated by findTilesInFOV.
+*/
+void TileEngine::applyTilesInFOV(BattleUnit *unit, FovUpdate &update)
+{
+	for (auto* tileVisited : update.revealedTiles)
+	{
+		Position posVisited = tileVisited->getPosition();
+
+		unit->addToVisibleTiles(tileVisited);
+		tileVisited->setVisible(+1);
+		tileVisited->setDiscovered(true, O_FLOOR);
+
+		// walls to the east or south of a visible tile, we see that too
+		Tile* t = _save->getTile(Position(posVisited.x + 1, posVisited.y, posVisited.z));
+		if (t) t->setDiscovered(true, O_WESTWALL);
+		t = _save->getTile(Position(posVisited.x, posVisited.y + 1, posVisited.z));
+		if (t) t->setDiscovered(true, O_NORTHWALL);
+	}
+}
+
 /**
 * Recalculates line of sight of a soldier.
 * @param unit Unit to check line of sight of.
@@ -1002,6 +1336,7 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 */
 bool TileEngine::calculateFOV(BattleUnit *unit, bool doTileRecalc, bool doUnitRecalc)
 {
+	FrameTraceScope trace("TileEngine::calculateFOV");
 	//Force a full FOV recheck for this unit.
 	if (doTileRecalc) calculateTilesInFOV(unit);
 	return doUnitRecalc ? calculateUnitsInFOV(unit) : false;
@@ -1044,6 +1379,18 @@ Position TileEngine::getSightOriginVoxel(BattleUnit *currentUnit)
  * @return True if visible.
  */
 bool TileEngine::visible(BattleUnit *currentUnit, Tile *tile)
+{
+	return visible(_voxelCheckCache, currentUnit, tile);
+}
+
+/**
+ * Checks for an opposing unit on this tile.
+ * @param cache Voxel cache of current thread.
+ * @param currentUnit The watcher.
+ * @param tile The tile to check for
+ * @return True if visible.
+ */
+bool TileEngine::visible(VoxelCheckCache &cache, BattleUnit *currentUnit, Tile *tile)
 {
 	// if there is no tile or no unit, we can't see it
 	if (!tile || !tile->getUnit())
@@ -1107,7 +1454,7 @@ bool TileEngine::visible(BattleUnit *currentUnit, Tile *tile)
 
 	Position scanVoxel;
 	std::vector<Position> _trajectory;
-	bool unitSeen = canTargetUnit(&originVoxel, tile, &scanVoxel, currentUnit, false);
+	bool unitSeen = canTargetUnit(cache, &originVoxel, tile, &scanVoxel, currentUnit, false, nullptr);
 
 	// heat vision 100% = smoke effectiveness 0%
 	int smokeDensityFactor = 100 - currentUnit->getArmor()->getHeatVision();
@@ -1120,7 +1467,7 @@ bool TileEngine::visible(BattleUnit *currentUnit, Tile *tile)
 		// so in fresh smoke we should only have 4 tiles of visibility
 		// this is traced in voxel space, with smoke affecting visibility every step of the way
 		_trajectory.clear();
-		calculateLineVoxel(originVoxel, scanVoxel, true, &_trajectory, currentUnit);
+		calculateLineVoxel(cache, originVoxel, scanVoxel, true, &_trajectory, currentUnit, nullptr, false);
 		int visibleDistanceVoxels = _trajectory.size();
 		int densityOfSmoke = 0;
 		int densityOfFire = 0;
@@ -1453,6 +1800,22 @@ int TileEngine::checkVoxelExposure(Position *originVoxel, Tile *tile, BattleUnit
  * @return True if the unit can be targetted.
  */
 bool TileEngine::canTargetUnit(Position *originVoxel, Tile *tile, Position *scanVoxel, BattleUnit *excludeUnit, bool rememberObstacles, BattleUnit *potentialUnit)
+{
+	return canTargetUnit(_voxelCheckCache, originVoxel, tile, scanVoxel, excludeUnit, rememberObstacles, potentialUnit);
+}
+
+/**
+ * Checks for another unit available for targeting and what particular voxel.
+ * @param cache Voxel cache of current thread, rememberObstacles can be only used by main thread.
+ * @param originVoxel Voxel of trace origin (eye or gun's barrel).
+ * @param tile The tile to check for.
+ * @param scanVoxel is returned coordinate of hit.
+ * @param excludeUnit is self (not to hit self).
+ * @param rememberObstacles Remember obstacles for no LOF indicator?
+ * @param potentialUnit is a hypothetical unit to draw a virtual line of fire for AI.
+ * @return True if the unit can be targetted.
+ */
+bool TileEngine::canTargetUnit(VoxelCheckCache &cache, Position *originVoxel, Tile *tile, Position *scanVoxel, BattleUnit *excludeUnit, bool rememberObstacles, BattleUnit *potentialUnit)
 {
 	Position targetVoxel = tile->getPosition().toVoxel() + Position(7, 8, 0);
 	std::vector<Position> _trajectory;
@@ -1514,7 +1877,7 @@ bool TileEngine::canTargetUnit(Position *originVoxel, Tile *tile, Position *scan
 			scanVoxel->x=targetVoxel.x + sliceTargets[j*2];
 			scanVoxel->y=targetVoxel.y + sliceTargets[j*2+1];
 			_trajectory.clear();
-			int test = calculateLineVoxel(*originVoxel, *scanVoxel, false, &_trajectory, excludeUnit);
+			int test = calculateLineVoxel(cache, *originVoxel, *scanVoxel, false, &_trajectory, excludeUnit, nullptr, false);
 			if (test == V_UNIT)
 			{
 				for (int x = 0; x <= targetSize; ++x)
@@ -1729,6 +2092,7 @@ bool TileEngine::canTargetTile(Position *originVoxel, Tile *tile, int part, Posi
  */
 void TileEngine::calculateFOV(Position position, int eventRadius, const bool updateTiles, const bool appendToTileVisibility)
 {
+	FrameTraceScope trace("TileEngine::calculateFOV");
 	int updateRadius;
 	if (eventRadius == -1)
 	{
@@ -1741,6 +2105,23 @@ void TileEngine::calculateFOV(Position position, int eventRadius, const bool upd
 		updateRadius = getMaxViewDistance() + (eventRadius > 0 ? eventRadius : 0);
 		updateRadius *= updateRadius;
 	}
+	if (canCalculateFOVThreaded())
+	{
+		std::vector<BattleUnit*> units;
+		for (auto* bu : *_save->getUnits())
+		{
+			if (Position::distance2dSq(position, bu->getPosition()) <= updateRadius) //could this unit have observed the event?
+			{
+				if (updateTiles && !appendToTileVisibility)
+				{
+					bu->clearVisibleTiles();
+				}
+				units.push_back(bu);
+			}
+		}
+		calculateFOVThreaded(units, position, eventRadius, updateTiles);
+		return;
+	}
 	for (std::vector<BattleUnit*>::iterator i = _save->getUnits()->begin(); i != _save->getUnits()->end(); ++i)
 	{
 		if (Position::distance2dSq(position, (*i)->getPosition()) <= updateRadius) //could this unit have observed the event?
@@ -1759,6 +2140,74 @@ void TileEngine::calculateFOV(Position position, int eventRadius, const bool upd
 	}
 }
 
+/**
+ * Checks if FOV can be calculated by worker threads.
+ * Visibility scripts with side effects (like debug_log) need to run on main thread.
+ * @return True if threaded FOV is enabled and safe to use.
+ */
+bool TileEngine::canCalculateFOVThreaded() const
+{
+	if (!Options::oxceThreadedFov)
+	{
+		return false;
+	}
+	for (auto* bu : *_save->getUnits())
+	{
+		if (bu->getArmor()->getScript<ModScript::VisibilityUnit>().haveAnySideEffects())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Calculates FOV of multiple units, tracing sight lines on worker threads.
+ * All changes to shared state are applied afterwards in order of units,
+ * so final result is same for any number of threads.
+ * @param units Units to update.
+ * @param eventPos The centre of the event which necessitated the FOV update.
+ * @param eventRadius The radius of a circle able to fully encompass the event, in tiles.
+ * @param updateTiles true to do an update of visible tiles.
+ */
+void TileEngine::calculateFOVThreaded(const std::vector<BattleUnit*> &units, const Position eventPos, const int eventRadius, bool updateTiles)
+{
+	FrameTraceScope trace("TileEngine::calculateFOVThreaded");
+	std::vector<FovUpdate> updates(units.size());
+	for (size_t i = 0; i < units.size(); ++i)
+	{
+		updates[i].updateTiles = updateTiles && prepareTilesInFOV(units[i], eventPos, eventRadius, updates[i]);
+		updates[i].updateUnits = prepareUnitsInFOV(units[i], eventPos, eventRadius, updates[i]);
+	}
+
+	ThreadPool::getShared().parallelFor(units.size(),
+		[&](size_t i)
+		{
+			VoxelCheckCache cache;
+			if (updates[i].updateTiles)
+			{
+				findTilesInFOV(units[i], eventPos, eventRadius, updates[i]);
+			}
+			if (updates[i].updateUnits)
+			{
+				findUnitsInFOV(units[i], updates[i], cache);
+			}
+		}
+	);
+
+	for (size_t i = 0; i < units.size(); ++i)
+	{
+		if (updates[i].updateTiles)
+		{
+			applyTilesInFOV(units[i], updates[i]);
+		}
+		if (updates[i].updateUnits)
+		{
+			applyUnitsInFOV(units[i], updates[i]);
+		}
+	}
+}
+
 /**
  * Checks if a sniper from the opposing faction sees this unit. The unit with the highest reaction score will be compared with the current unit's reaction score.
  * If it's higher, a shot is fired when enough time units, a weapon and ammo are available.
@@ -2575,13 +3024,19 @@ void TileEngine::hit(BattleActionAttack attack, Position center, int power, cons
  */
 void TileEngine::explode(BattleActionAttack attack, Position center, int power, const RuleDamageType *type, int maxRadius, bool rangeAtack)
 {
+	FrameTraceScope trace("TileEngine::explode");
 	const Position centetTile = center.toTile();
 	int hitSide = 0;
 	int diagonalWall = 0;
 	int power_;
-	std::map<Tile*, int> tilesAffected;
+	std::vector<int> tilesAffected;
 	std::vector<BattleItem*> toRemove;
-	std::pair<std::map<Tile*, int>::iterator, bool> ret;
+
+	// damage for each tile, -1 for tiles not affected yet.
+	if (_explosionDamage.size() != (size_t)_save->getMapSizeXYZ())
+	{
+		_explosionDamage.assign(_save->getMapSizeXYZ(), -1);
+	}
 
 	if (type->FireBlastCalc)
 	{
@@ -2614,140 +3069,146 @@ void TileEngine::explode(BattleActionAttack attack, Position center, int power,
 			hitSide = (center.x % 16 + center.y % 16 - 15) > 0 ? 1 : -1;
 	}
 
-	for (int fi = -90; fi <= 90; fi += 5)
+	const std::vector<ExplosionRayStep> &raySteps = getExplosionRays(maxRadius);
+	for (int ray = 0; ray < ExplosionRayCount; ++ray)
 	{
-		// raytrace every 3 degrees makes sure we cover all tiles in a circle.
-		for (int te = 0; te <= 360; te += 3)
-		{
-			double cos_te = cos(Deg2Rad(te));
-			double sin_te = sin(Deg2Rad(te));
-			double sin_fi = sin(Deg2Rad(fi));
-			double cos_fi = cos(Deg2Rad(fi));
+		const int te = (ray % ExplosionRayAzimuthCount) * ExplosionRayAzimuthStep;
+		const ExplosionRayStep *steps = raySteps.data() + ray * std::max(maxRadius, 0);
 
-			origin = _save->getTile(centetTile);
-			dest = origin;
-			double l = 0;
-			int tileX, tileY, tileZ;
-			power_ = power;
-			while (power_ > 0 && l <= maxRadius)
+		origin = _save->getTile(centetTile);
+		dest = origin;
+		int l = 0;
+		power_ = power;
+		while (power_ > 0 && l <= maxRadius)
+		{
+			if (power_ > 0)
 			{
-				if (power_ > 0)
+				int &tileDamage = _explosionDamage[_save->getTileIndex(dest->getPosition())];
+				const bool firstHit = tileDamage == -1; // check if we had this tile already affected
+				if (firstHit)
 				{
-					ret = tilesAffected.insert(std::make_pair(dest, 0)); // check if we had this tile already affected
+					tileDamage = 0;
+					tilesAffected.push_back(_save->getTileIndex(dest->getPosition()));
+				}
 
-					const int tileDmg = type->getTileFinalDamage(power_);
-					if (tileDmg > ret.first->second)
-					{
-						ret.first->second = tileDmg;
-					}
-					if (ret.second)
-					{
-						const int damage = type->getRandomDamage(power_);
-						BattleUnit *bu = dest->getOverlappingUnit(_save);
+				const int tileDmg = type->getTileFinalDamage(power_);
+				if (tileDmg > tileDamage)
+				{
+					tileDamage = tileDmg;
+				}
+				if (firstHit)
+				{
+					const int damage = type->getRandomDamage(power_);
+					BattleUnit *bu = dest->getOverlappingUnit(_save);
 
-						toRemove.clear();
-						if (bu)
+					toRemove.clear();
+					if (bu)
+					{
+						if (Position::distance2d(dest->getPosition(), centetTile) < 2)
 						{
-							if (Position::distance2d(dest->getPosition(), centetTile) < 2)
-							{
-								// ground zero effect is in effect
-								hitUnit(attack, bu, Position(0, 0, 0), damage, type, rangeAtack);
-							}
-							else
-							{
-								// directional damage relative to explosion position.
-								// units above the explosion will be hit in the legs, units lateral to or below will be hit in the torso
-								hitUnit(attack, bu, centetTile + Position(0, 0, 5) - dest->getPosition(), damage, type, rangeAtack);
-							}
+							// ground zero effect is in effect
+							hitUnit(attack, bu, Position(0, 0, 0), damage, type, rangeAtack);
+						}
+						else
+						{
+							// directional damage relative to explosion position.
+							// units above the explosion will be hit in the legs, units lateral to or below will be hit in the torso
+							hitUnit(attack, bu, centetTile + Position(0, 0, 5) - dest->getPosition(), damage, type, rangeAtack);
+						}
 
-							// Affect all items and units in inventory
-							const int itemDamage = bu->getOverKillDamage();
-							if (itemDamage > 0)
+						// Affect all items and units in inventory
+						const int itemDamage = bu->getOverKillDamage();
+						if (itemDamage > 0)
+						{
+							for (std::vector<BattleItem*>::iterator it = bu->getInventory()->begin(); it != bu->getInventory()->end(); ++it)
 							{
-								for (std::vector<BattleItem*>::iterator it = bu->getInventory()->begin(); it != bu->getInventory()->end(); ++it)
+								if (!hitUnit(attack, (*it)->getUnit(), Position(0, 0, 0), itemDamage, type, rangeAtack) && type->getItemFinalDamage(itemDamage) > (*it)->getRules()->getArmor())
 								{
-									if (!hitUnit(attack, (*it)->getUnit(), Position(0, 0, 0), itemDamage, type, rangeAtack) && type->getItemFinalDamage(itemDamage) > (*it)->getRules()->getArmor())
-									{
-										toRemove.push_back(*it);
-									}
+									toRemove.push_back(*it);
 								}
 							}
 						}
-						// Affect all items and units on ground
-						for (std::vector<BattleItem*>::iterator it = dest->getInventory()->begin(); it != dest->getInventory()->end(); ++it)
-						{
-							if (!hitUnit(attack, (*it)->getUnit(), Position(0, 0, 0), damage, type) && type->getItemFinalDamage(damage) > (*it)->getRules()->getArmor())
-							{
-								toRemove.push_back(*it);
-							}
-						}
-						for (std::vector<BattleItem*>::iterator it = toRemove.begin(); it != toRemove.end(); ++it)
+					}
+					// Affect all items and units on ground
+					for (std::vector<BattleItem*>::iterator it = dest->getInventory()->begin(); it != dest->getInventory()->end(); ++it)
+					{
+						if (!hitUnit(attack, (*it)->getUnit(), Position(0, 0, 0), damage, type) && type->getItemFinalDamage(damage) > (*it)->getRules()->getArmor())
 						{
-							_save->removeItem((*it));
+							toRemove.push_back(*it);
 						}
-
-						hitTile(dest, damage, type);
 					}
+					for (std::vector<BattleItem*>::iterator it = toRemove.begin(); it != toRemove.end(); ++it)
+					{
+						_save->removeItem((*it));
+					}
+
+					hitTile(dest, damage, type);
 				}
+			}
+
+			l += 1;
 
-				l += 1.0;
+			if (l > maxRadius) break; // end of ray, next step would not be used.
 
-				tileX = int(floor(centetTile.x + 0.5 + l * sin_te * cos_fi));
-				tileY = int(floor(centetTile.y + 0.5 + l * cos_te * cos_fi));
-				tileZ = int(floor(centetTile.z + 0.5 + l * sin_fi));
+			const ExplosionRayStep &step = steps[l - 1];
 
-				origin = dest;
-				dest = _save->getTile(Position(tileX, tileY, tileZ));
+			origin = dest;
+			dest = _save->getTile(centetTile + Position(step.x, step.y, step.z));
 
-				if (!dest) break; // out of map!
+			if (!dest) break; // out of map!
 
-				// blockage by terrain is deducted from the explosion power
-				power_ -= type->RadiusReduction; // explosive damage decreases by 10 per tile
-				if (origin->getPosition().z != tileZ)
-					power_ -= vertdec; //3d explosion factor
+			// blockage by terrain is deducted from the explosion power
+			power_ -= type->RadiusReduction; // explosive damage decreases by 10 per tile
+			if (step.vertical)
+				power_ -= vertdec; //3d explosion factor
 
-				if (type->FireBlastCalc)
+			if (type->FireBlastCalc)
+			{
+				if (step.diagonal) power_ -= 0.5f * type->RadiusReduction; // diagonal movement costs an extra 50% for fire.
+			}
+			if (l > 1)
+			{
+				power_ -= verticalBlockage(origin, dest, type->ResistType, false) * 2;
+				power_ -= horizontalBlockage(origin, dest, type->ResistType, false) * 2;
+			}
+			else //tricky bigwall deflection /Volutar
+			{
+				bool skipObject = diagonalWall == 0;
+				if (diagonalWall == Pathfinding::BIGWALLNESW) // --
 				{
-					int dir;
-					Pathfinding::vectorToDirection(origin->getPosition() - dest->getPosition(), dir);
-					if (dir != -1 && dir %2) power_ -= 0.5f * type->RadiusReduction; // diagonal movement costs an extra 50% for fire.
+					if (hitSide<0 && te >= 135 && te < 315)
+						skipObject = true;
+					if (hitSide>0 && ( te < 135 || te > 315))
+						skipObject = true;
 				}
-				if (l > 0.5) {
-					if ( l > 1.5)
-					{
-						power_ -= verticalBlockage(origin, dest, type->ResistType, false) * 2;
-						power_ -= horizontalBlockage(origin, dest, type->ResistType, false) * 2;
-					}
-					else //tricky bigwall deflection /Volutar
-					{
-						bool skipObject = diagonalWall == 0;
-						if (diagonalWall == Pathfinding::BIGWALLNESW) // --
-						{
-							if (hitSide<0 && te >= 135 && te < 315)
-								skipObject = true;
-							if (hitSide>0 && ( te < 135 || te > 315))
-								skipObject = true;
-						}
-						if (diagonalWall == Pathfinding::BIGWALLNWSE) // |
-						{
-							if (hitSide>0 && te >= 45 && te < 225)
-								skipObject = true;
-							if (hitSide<0 && ( te < 45 || te > 225))
-								skipObject = true;
-						}
-						power_ -= verticalBlockage(origin, dest, type->ResistType, skipObject) * 2;
-						power_ -= horizontalBlockage(origin, dest, type->ResistType, skipObject) * 2;
-
-					}
+				if (diagonalWall == Pathfinding::BIGWALLNWSE) // |
+				{
+					if (hitSide>0 && te >= 45 && te < 225)
+						skipObject = true;
+					if (hitSide<0 && ( te < 45 || te > 225))
+						skipObject = true;
 				}
+				power_ -= verticalBlockage(origin, dest, type->ResistType, skipObject) * 2;
+				power_ -= horizontalBlockage(origin, dest, type->ResistType, skipObject) * 2;
+
 			}
 		}
 	}
 
+	// detonate tiles in order of map, same as any other map wide update.
+	std::sort(tilesAffected.begin(), tilesAffected.end());
+	std::vector<std::pair<Tile*, int>> tilesDamage;
+	tilesDamage.reserve(tilesAffected.size());
+	for (int i : tilesAffected)
+	{
+		tilesDamage.push_back(std::make_pair(_save->getTile(i), _explosionDamage[i]));
+		_explosionDamage[i] = -1;
+	}
+
 	// now detonate the tiles affected by explosion
 	if (type->ToTile > 0.0f)
 	{
-		for (std::map<Tile*, int>::iterator i = tilesAffected.begin(); i != tilesAffected.end(); ++i)
+		for (std::vector<std::pair<Tile*, int>>::iterator i = tilesDamage.begin(); i != tilesDamage.end(); ++i)
 		{
 			if (detonate(i->first, i->second))
 			{
@@ -2847,6 +3308,7 @@ bool TileEngine::detonate(Tile* tile, int explosive)
 				currentpart2 = tiles[i]->getMapData(currentpart)->getDataset()->getObject(diemcd)->getObjectType();
 			else
 				currentpart2 = currentpart;
+			_save->updateMapVersion();
 			if (tiles[i]->destroy(currentpart, _save->getObjectiveType()))
 				objective = true;
 			currentpart =  currentpart2;
@@ -3434,6 +3896,7 @@ int TileEngine::unitOpensDoor(BattleUnit *unit, bool rClick, int dir)
 
 	if (door == 0 || door == 1)
 	{
+		_save->updateMapVersion();
 		if (_save->getBattleGame()->checkReservedTU(unit, TUCost, 0))
 		{
 			if (unit->spendTimeUnits(TUCost))
@@ -3522,6 +3985,10 @@ int TileEngine::closeUfoDoors()
 		}
 		doorsclosed += _save->getTile(i)->closeUfoDoor();
 	}
+	if (doorsclosed)
+	{
+		_save->updateMapVersion();
+	}
 
 	return doorsclosed;
 }
@@ -3615,6 +4082,23 @@ int TileEngine::calculateLineTile(Position origin, Position target, std::vector<
  * @return the objectnumber(0-3) or unit(4) or out of map (5) or -1(hit nothing).
  */
 VoxelType TileEngine::calculateLineVoxel(Position origin, Position target, bool storeTrajectory, std::vector<Position> *trajectory, BattleUnit *excludeUnit, BattleUnit *excludeAllBut, bool onlyVisible)
+{
+	return calculateLineVoxel(_voxelCheckCache, origin, target, storeTrajectory, trajectory, excludeUnit, excludeAllBut, onlyVisible);
+}
+
+/**
+ * Calculates a line trajectory, using bresenham algorithm in 3D.
+ * @param cache Voxel cache of current thread.
+ * @param origin Origin in voxel.
+ * @param target Target in voxel.
+ * @param storeTrajectory True will store the whole trajectory - otherwise it just stores the last position.
+ * @param trajectory A vector of positions in which the trajectory is stored.
+ * @param excludeUnit Excludes this unit in the collision detection.
+ * @param excludeAllBut The only unit to be considered for ray hits.
+ * @param onlyVisible Skip invisible units?
+ * @return the objectnumber(0-3) or unit(4) or out of map (5) or -1(hit nothing).
+ */
+VoxelType TileEngine::calculateLineVoxel(VoxelCheckCache &cache, Position origin, Position target, bool storeTrajectory, std::vector<Position> *trajectory, BattleUnit *excludeUnit, BattleUnit *excludeAllBut, bool onlyVisible)
 {
 	VoxelType result;
 	bool excludeAllUnits = false;
@@ -3631,7 +4115,7 @@ VoxelType TileEngine::calculateLineVoxel(Position origin, Position target, bool
 				trajectory->push_back(point);
 			}
 
-			result = voxelCheck(point, excludeUnit, excludeAllUnits, onlyVisible, excludeAllBut);
+			result = voxelCheck(cache, point, excludeUnit, excludeAllUnits, onlyVisible, excludeAllBut);
 			if (result != V_EMPTY)
 			{
 				if (trajectory)
@@ -3645,7 +4129,7 @@ VoxelType TileEngine::calculateLineVoxel(Position origin, Position target, bool
 		[&](Position point)
 		{
 			//check for xy diagonal intermediate voxel step
-			result = voxelCheck(point, excludeUnit, excludeAllUnits, onlyVisible, excludeAllBut);
+			result = voxelCheck(cache, point, excludeUnit, excludeAllUnits, onlyVisible, excludeAllBut);
 			if (result != V_EMPTY)
 			{
 				if (trajectory != 0)
@@ -3784,6 +4268,21 @@ bool TileEngine::isVoxelVisible(Position voxel)
  * @return The objectnumber(0-3) or unit(4) or out of map (5) or -1 (hit nothing).
  */
 VoxelType TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool excludeAllUnits, bool onlyVisible, BattleUnit *excludeAllBut)
+{
+	return voxelCheck(_voxelCheckCache, voxel, excludeUnit, excludeAllUnits, onlyVisible, excludeAllBut);
+}
+
+/**
+ * Checks if we hit a voxel.
+ * @param cache Voxel cache of current thread.
+ * @param voxel The voxel to check.
+ * @param excludeUnit Don't do checks on this unit.
+ * @param excludeAllUnits Don't do checks on any unit.
+ * @param onlyVisible Whether to consider only visible units.
+ * @param excludeAllBut If set, the only unit to be considered for ray hits.
+ * @return The objectnumber(0-3) or unit(4) or out of map (5) or -1 (hit nothing).
+ */
+VoxelType TileEngine::voxelCheck(VoxelCheckCache &cache, Position voxel, BattleUnit *excludeUnit, bool excludeAllUnits, bool onlyVisible, BattleUnit *excludeAllBut)
 {
 	if (voxel.x < 0 || voxel.y < 0 || voxel.z < 0) //preliminary out of map
 	{
@@ -3791,10 +4290,12 @@ VoxelType TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool e
 	}
 	Position pos = voxel.toTile();
 	Tile *tile, *tileBelow;
-	if (_cacheTilePos == pos)
+	const TileVoxelCache *voxels;
+	if (cache.pos == pos)
 	{
-		tile = _cacheTile;
-		tileBelow = _cacheTileBelow;
+		tile = cache.tile;
+		tileBelow = cache.tileBelow;
+		voxels = cache.voxels;
 	}
 	else
 	{
@@ -3804,9 +4305,11 @@ VoxelType TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool e
 			return V_OUTOFBOUNDS; //not even cache
 		}
 		tileBelow = _save->getBelowTile(tile);
-		_cacheTilePos = pos;
-		_cacheTile = tile;
-		_cacheTileBelow = tileBelow;
+		voxels = &_save->getTileVoxels(_save->getTileIndex(pos));
+		cache.pos = pos;
+		cache.tile = tile;
+		cache.tileBelow = tileBelow;
+		cache.voxels = voxels;
  	}
 
 	if (tile->isVoid() && tile->getUnit() == 0 && (!tileBelow || tileBelow->getUnit() == 0))
@@ -3814,7 +4317,7 @@ VoxelType TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool e
 		return V_EMPTY;
 	}
 
-	if (tile->getMapData(O_FLOOR) && tile->getMapData(O_FLOOR)->isGravLift() && (voxel.z % 24 == 0 || voxel.z % 24 == 1))
+	if (voxels->gravLift && (voxel.z % 24 == 0 || voxel.z % 24 == 1))
 	{
 		if ((tile->getPosition().z == 0) || (tileBelow && tileBelow->getMapData(O_FLOOR) && !tileBelow->getMapData(O_FLOOR)->isGravLift()))
 		{
@@ -3823,17 +4326,18 @@ VoxelType TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool e
 	}
 
 	// first we check terrain voxel data, not to allow 2x2 units stick through walls
-	for (int i = V_FLOOR; i <= V_OBJECT; ++i)
+	if (voxels->parts)
 	{
-		TilePart tp = (TilePart)i;
-		MapData *mp = tile->getMapData(tp);
-		if (((tp == O_WESTWALL) || (tp == O_NORTHWALL)) && tile->isUfoDoorOpen(tp))
-			continue;
-		if (mp != 0)
+		const int x = 15 - voxel.x%16;
+		const int y = voxel.y%16;
+		const int layer = (voxel.z%24)/2;
+		for (int i = V_FLOOR; i <= V_OBJECT; ++i)
 		{
-			int x = 15 - voxel.x%16;
-			int y = voxel.y%16;
-			int idx = (mp->getLoftID((voxel.z%24)/2)*16) + y;
+			if (!(voxels->parts & (1 << i)))
+				continue;
+			if ((voxels->ufoDoorParts & (1 << i)) && tile->isUfoDoorOpen((TilePart)i))
+				continue;
+			int idx = (voxels->loftID[i][layer]*16) + y;
 			if (_voxelData->at(idx) & (1 << x))
 			{
 				return (VoxelType)i;
@@ -3885,9 +4389,7 @@ VoxelType TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool e
 
 void TileEngine::voxelCheckFlush()
 {
-	_cacheTilePos = invalid;
-	_cacheTile = 0;
-	_cacheTileBelow = 0;
+	_voxelCheckCache = VoxelCheckCache{};
 }
 
 /**
@@ -4926,6 +5428,20 @@ bool TileEngine::validateThrow(BattleAction &action, Position originVoxel, Posit
  */
 void TileEngine::recalculateFOV()
 {
+	FrameTraceScope trace("TileEngine::recalculateFOV");
+	if (canCalculateFOVThreaded())
+	{
+		std::vector<BattleUnit*> units;
+		for (auto* bu : *_save->getUnits())
+		{
+			if (bu->getTile() != 0)
+			{
+				units.push_back(bu);
+			}
+		}
+		calculateFOVThreaded(units, invalid, 0, true);
+		return;
+	}
 	for (std::vector<BattleUnit*>::iterator bu = _save->getUnits()->begin(); bu != _save->getUnits()->end(); ++bu)
 	{
 		if ((*bu)->getTile() != 0)
@@ -18,6 +18,8 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <vector>
+#include <map>
+#include <tuple>
 #include "Position.h"
 #include "BattlescapeGame.h"
 #include "../Mod/RuleItem.h"
@@ -31,6 +33,7 @@ class SavedBattleGame;
 class BattleUnit;
 class BattleItem;
 class Tile;
+struct TileVoxelCache;
 class RuleSkill;
 struct BattleAction;
 template<typename Tag, typename DataType> struct AreaSubset;
@@ -45,6 +48,18 @@ enum BattleActionType : Uint8;
 enum LightLayers : Uint8;
 
 
+/**
+ * Helper class storing last tile used by voxelCheck.
+ * Every thread that trace voxels need its own copy.
+ */
+struct VoxelCheckCache
+{
+	Position pos = { -1, -1, -1 };
+	Tile *tile = nullptr;
+	Tile *tileBelow = nullptr;
+	const TileVoxelCache *voxels = nullptr;
+};
+
 /**
  * A utility class that modifies tile properties on a battlescape map. This includes lighting, destruction, smoke, fire, fog of war.
  * Note that this function does not handle any sounds or animations.
@@ -79,6 +94,59 @@ private:
 		Uint8 smoke: 1;
 		Uint8 fire: 1;
 	};
+	/**
+	 * Helper class storing circle sector around event as seen by observer.
+	 */
+	struct EventVisibilitySector
+	{
+		Position left, right;
+		Position observerPos = { -1, -1, -1 };
+	};
+	/**
+	 * Helper class storing FOV of one unit that is calculated in two steps,
+	 * first can be done by worker thread, second apply shared changes on main thread.
+	 */
+	struct FovUpdate
+	{
+		EventVisibilitySector sector;
+		bool skipNarrowArcTest = false;
+		bool updateTiles = false;
+		bool updateUnits = false;
+		bool newUnitsSpotted = false;
+		/// Tiles on sight lines of unit.
+		std::vector<Tile*> revealedTiles;
+		/// Units seen by unit.
+		std::vector<BattleUnit*> seenUnits;
+		/// Units seen by unit for first time.
+		std::vector<BattleUnit*> spottedUnits;
+	};
+	/**
+	 * Helper class storing light that reach one tile from source, before cut by light already on tile.
+	 */
+	struct LitTile
+	{
+		Position position;
+		/// Light of source reduced only by distance.
+		Uint8 light;
+		/// Light left in both rays traced to tile.
+		Uint8 lightA, lightB;
+	};
+	/**
+	 * Helper class storing light that one source gives to tiles around it.
+	 */
+	struct LightContribution
+	{
+		Position center;
+		int power = 0;
+		/// Last lighting pass that used this, zero if not calculated yet.
+		Uint32 lastUsed = 0;
+		/// Tiles lit by source.
+		std::vector<LitTile> tiles;
+	};
+	/// Light layer, tile index of center and power of source.
+	using LightSourceKey = std::tuple<int, int, int>;
+	/// Number of cached light sources of one layer after which unused ones are removed.
+	constexpr static size_t MaxLightContributions = 1024;
 	/**
 	 * Helper class storing reaction data.
 	 */
@@ -97,9 +165,11 @@ private:
 	RuleInventory *_inventorySlotGround;
 	constexpr static int heightFromCenter[11] = {0,-2,+2,-4,+4,-6,+6,-8,+8,-12,+12};
 	bool _personalLighting;
-	Tile *_cacheTile;
-	Tile *_cacheTileBelow;
-	Position _cacheTilePos;
+	VoxelCheckCache _voxelCheckCache;
+	std::map<LightSourceKey, LightContribution> _lightContributions;
+	Uint32 _lightingPass = 0;
+	/// Damage of each tile during explosion, -1 for tiles not affected.
+	std::vector<int> _explosionDamage;
 	const int _maxViewDistance;        // 20 tiles by default
 	const int _maxViewDistanceSq;      // 20 * 20
 	const int _maxVoxelViewDistance;   // maxViewDistance * 16
@@ -107,12 +177,17 @@ private:
 	const int _maxStaticLightDistance;
 	const int _maxDynamicLightDistance;
 	const int _enhancedLighting;
-	Position _eventVisibilitySectorL, _eventVisibilitySectorR, _eventVisibilityObserverPos;
 	std::vector<BattleUnit*> _movingUnitPrev;
 	BattleUnit* _movingUnit = nullptr;
 
 	/// Add light source.
 	void addLight(MapSubset gs, Position center, int power, LightLayers layer);
+	/// Gets cached light of one source.
+	const LightContribution &getLightContribution(Position center, int power, LightLayers layer);
+	/// Removes cached light of sources around part of map.
+	void invalidateLightContributions(MapSubset gs);
+	/// Calculates enhanced light of one source.
+	void calculateLightContribution(Position center, int power, LightLayers layer, std::vector<LitTile> &tiles);
 	/// Calculate blockage amount.
 	int blockage(Tile *tile, const TilePart part, ItemDamageType type, int direction = -1, bool checkingFromOrigin = false);
 	/// Get max distance that fire light can reach.
@@ -130,8 +205,32 @@ private:
 	/// Get threshold of darkness for LoS calculation.
 	int getMaxDarknessToSeeUnits() const { return _maxDarknessToSeeUnits; }
 
-	bool setupEventVisibilitySector(const Position &observerPos, const Position &eventPos, const int &eventRadius);
-	inline bool inEventVisibilitySector(const Position &toCheck) const;
+	bool setupEventVisibilitySector(EventVisibilitySector &sector, const Position &observerPos, const Position &eventPos, const int &eventRadius) const;
+	inline bool inEventVisibilitySector(const EventVisibilitySector &sector, const Position &toCheck) const;
+
+	/// Prepares unit for update of visible tiles, returns true if there is anything to calculate.
+	bool prepareTilesInFOV(BattleUnit *unit, const Position eventPos, const int eventRadius, FovUpdate &update);
+	/// Finds tiles visible by unit, do not change any shared state.
+	void findTilesInFOV(BattleUnit *unit, const Position eventPos, const int eventRadius, FovUpdate &update);
+	/// Applies tiles found by findTilesInFOV.
+	void applyTilesInFOV(BattleUnit *unit, FovUpdate &update);
+	/// Prepares unit for update of visible units, returns true if there is anything to calculate.
+	bool prepareUnitsInFOV(BattleUnit *unit, const Position eventPos, const int eventRadius, FovUpdate &update);
+	/// Finds units visible by unit, change only visibility lists of this unit.
+	void findUnitsInFOV(BattleUnit *unit, FovUpdate &update, VoxelCheckCache &cache);
+	/// Applies units found by findUnitsInFOV.
+	bool applyUnitsInFOV(BattleUnit *unit, FovUpdate &update);
+	/// Checks if FOV can be calculated by worker threads.
+	bool canCalculateFOVThreaded() const;
+	/// Calculates FOV of multiple units using worker threads.
+	void calculateFOVThreaded(const std::vector<BattleUnit*> &units, const Position eventPos, const int eventRadius, bool updateTiles);
+
+	/// Checks visibility of a unit on this tile, using given voxel cache.
+	bool visible(VoxelCheckCache &cache, BattleUnit *currentUnit, Tile *tile);
+	/// Calculates a line trajectory in voxel space, using given voxel cache.
+	VoxelType calculateLineVoxel(VoxelCheckCache &cache, Position origin, Position target, bool storeTrajectory, std::vector<Position> *trajectory, BattleUnit *excludeUnit, BattleUnit *excludeAllBut, bool onlyVisible);
+	/// Checks what type of voxel occupies this space, using given voxel cache.
+	VoxelType voxelCheck(VoxelCheckCache &cache, Position voxel, BattleUnit *excludeUnit, bool excludeAllUnits, bool onlyVisible, BattleUnit *excludeAllBut);
 
 	/// Calculates sun shading of the whole map.
 	void calculateSunShading(MapSubset gs);
@@ -250,6 +349,8 @@ public:
 	int checkVoxelExposure(Position *originVoxel, Tile *tile, BattleUnit *excludeUnit, BattleUnit *excludeAllBut);
 	/// Checks validity for targetting a unit.
 	bool canTargetUnit(Position *originVoxel, Tile *tile, Position *scanVoxel, BattleUnit *excludeUnit, bool rememberObstacles, BattleUnit *potentialUnit = 0);
+	/// Checks validity for targetting a unit, using given voxel cache. Without remembering obstacles it is safe to call from worker threads.
+	bool canTargetUnit(VoxelCheckCache &cache, Position *originVoxel, Tile *tile, Position *scanVoxel, BattleUnit *excludeUnit, bool rememberObstacles, BattleUnit *potentialUnit);
 	/// Check validity for targetting a tile.
 	bool canTargetTile(Position *originVoxel, Tile *tile, int part, Position *scanVoxel, BattleUnit *excludeUnit, bool rememberObstacles);
 	/// Calculates the z voxel for shadows.
@@ -72,6 +72,8 @@
 #include <unistd.h>
 #include <sys/param.h>
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <pwd.h>
 #include <execinfo.h>
 #include <cxxabi.h>
@@ -880,6 +882,34 @@ time_t getDateModified(const std::string &path)
 #endif
 }
 
+/**
+ * Gets the size of a file.
+ * @param path Full path to file.
+ * @return The size in bytes, zero if file can't be accessed.
+ */
+Uint64 getFileSize(const std::string &path)
+{
+#ifdef _WIN32
+	auto pathW = pathToWindows(path);
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (GetFileAttributesExW(pathW.c_str(), GetFileExInfoStandard, &data))
+	{
+		return ((Uint64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+	}
+	return 0;
+#else
+	struct stat info;
+	if (stat(path.c_str(), &info) == 0)
+	{
+		return info.st_size;
+	}
+	else
+	{
+		return 0;
+	}
+#endif
+}
+
 /**
  * Converts a date/time into a human-readable string
  * using the ISO 8601 standard.
@@ -1033,6 +1063,80 @@ std::unique_ptr<std::istream> readFile(const std::string& filename) {
 	return std::unique_ptr<std::istream>(new std::istringstream(datastr));
 }
 
+/**
+ * Maps a whole file to memory for reading, pages are only loaded when accessed.
+ * @param filename Full path of the file.
+ * @param size Returns size of the file.
+ * @return Pointer to file data or NULL when mapping failed.
+ */
+const void *mapFile(const std::string& filename, size_t *size)
+{
+#ifdef _WIN32
+	auto pathW = pathToWindows(filename);
+	auto fh = CreateFileW(pathW.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (fh == INVALID_HANDLE_VALUE)
+	{
+		return NULL;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fh, &fileSize) || fileSize.QuadPart == 0 || (Uint64)fileSize.QuadPart > SIZE_MAX)
+	{
+		CloseHandle(fh);
+		return NULL;
+	}
+	auto mh = CreateFileMappingW(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(fh);
+	if (mh == NULL)
+	{
+		return NULL;
+	}
+	// the view keeps the mapping alive
+	void *data = MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mh);
+	if (data == NULL)
+	{
+		return NULL;
+	}
+	*size = (size_t)fileSize.QuadPart;
+	return data;
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return NULL;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0)
+	{
+		close(fd);
+		return NULL;
+	}
+	// the mapping stays valid after closing the descriptor
+	void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+	{
+		return NULL;
+	}
+	*size = info.st_size;
+	return data;
+#endif
+}
+
+/**
+ * Unmaps a file mapped by mapFile.
+ * @param data Pointer returned by mapFile.
+ * @param size Size of the file.
+ */
+void unmapFile(const void *data, size_t size)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+#else
+	munmap(const_cast<void*>(data), size);
+#endif
+}
+
 /**
  * Gets an istream to a file's bytes at least up to and including first "\n---" sequence.
  * To be used only for savegames.
@@ -1063,7 +1167,10 @@ std::unique_ptr<std::istream> getYamlSaveHeader(const std::string& filename) {
 		size += actually_read;
 		data[size] = 0;
 		size_t search_from = offs > 4 ? offs - 4 : 0;
-		if (NULL != strstr(data+search_from, "\n---")) {
+		const char *separator = strstr(data+search_from, "\n---");
+		if (NULL != separator) {
+			// anything after header can be binary data
+			size = separator - data + 1;
 			break;
 		}
 		char *newdata = (char *)SDL_realloc(data, size+chunksize+1);
@@ -41,6 +41,8 @@
 #include <istream>
 #include <unordered_map>
 #include <unordered_set>
+#include <map>
+#include <mutex>
 
 #include "FileMap.h"
 #include "Unicode.h"
@@ -235,13 +237,263 @@ static inline std::string concatOptionalPaths(const std::string& basePath, const
 	}
 }
 
+/**
+ * Opened zip archive. Archives from files are memory mapped, so stored files
+ * can be read straight from the map and decompression does not need file access.
+ */
+struct ZipContext
+{
+	mz_zip_archive zip;		// first member, FileRecord::zip points here
+	const void *map;		// memory mapped file, NULL when read through rwops
+	size_t mapSize;
+	int openMembers;		// rwops still reading from the map
+	bool closed;			// unmap when last member is closed
+};
+
+/**
+ * Decompressed zip member shared by all rwops reading it.
+ */
+struct ZipMemberData
+{
+	void *data;
+	size_t size;
+	int refs;
+	Uint64 lastUse;
+	bool cached;			// false when dropped from cache but still read
+};
+
+/**
+ * Data of an opened rwops, to release it on close.
+ */
+struct ZipOpenMember
+{
+	ZipContext *ctx;		// set for stored members read from the map
+	ZipMemberData *member;	// set for decompressed members
+	int count;
+};
+
+/// Size of unused decompressed members kept in memory.
+static const size_t ZipCacheLimit = 32 * 1024 * 1024;
+
+static std::mutex ZipMutex;
+static std::map<std::pair<const ZipContext*, mz_uint>, ZipMemberData*> ZipCache;
+static std::unordered_map<const void*, ZipOpenMember> ZipOpenMembers;
+static size_t ZipCacheSize = 0;
+static Uint64 ZipCacheCounter = 0;
+
+static void destroyZipContext(ZipContext *ctx)
+{
+	if (ctx->map)
+	{
+		mz_zip_reader_end(&ctx->zip);
+		CrossPlatform::unmapFile(ctx->map, ctx->mapSize);
+	}
+	else
+	{
+		mz_zip_reader_end_rwops(&ctx->zip);
+	}
+	delete ctx;
+}
+
+static void freeZipMember(ZipMemberData *member)
+{
+	mz_free(member->data);
+	delete member;
+}
+
+/**
+ * Drops least recently used members that are not read by anyone until cache fits in its limit.
+ * Needs ZipMutex to be locked.
+ */
+static void trimZipCache()
+{
+	while (ZipCacheSize > ZipCacheLimit)
+	{
+		auto lru = ZipCache.end();
+		for (auto i = ZipCache.begin(); i != ZipCache.end(); ++i)
+		{
+			if (i->second->refs == 0 && (lru == ZipCache.end() || i->second->lastUse < lru->second->lastUse))
+			{
+				lru = i;
+			}
+		}
+		if (lru == ZipCache.end())
+		{
+			return;
+		}
+		ZipCacheSize -= lru->second->size;
+		freeZipMember(lru->second);
+		ZipCache.erase(lru);
+	}
+}
+
+/**
+ * Releases data of a closed rwops.
+ */
+static int zipMemberClose(SDL_RWops *context)
+{
+	if (context)
+	{
+		std::lock_guard<std::mutex> lock(ZipMutex);
+		auto i = ZipOpenMembers.find(context->hidden.mem.base);
+		if (i != ZipOpenMembers.end())
+		{
+			ZipOpenMember &open = i->second;
+			if (open.member)
+			{
+				open.member->refs -= 1;
+				if (open.member->refs == 0)
+				{
+					if (!open.member->cached)
+					{
+						freeZipMember(open.member);
+					}
+					else
+					{
+						trimZipCache();
+					}
+				}
+			}
+			if (open.ctx)
+			{
+				open.ctx->openMembers -= 1;
+				if (open.ctx->closed && open.ctx->openMembers == 0)
+				{
+					destroyZipContext(open.ctx);
+				}
+			}
+			if (--open.count == 0)
+			{
+				ZipOpenMembers.erase(i);
+			}
+		}
+		SDL_FreeRW(context);
+	}
+	return 0;
+}
+
+/**
+ * Creates rwops reading given data, data is released when it is closed.
+ * Needs ZipMutex to be locked.
+ */
+static SDL_RWops *newZipMemberRWops(const void *data, size_t size, ZipContext *ctx, ZipMemberData *member)
+{
+	SDL_RWops *rv = SDL_RWFromConstMem(data, size);
+	if (!rv) { return NULL; }
+	rv->close = zipMemberClose;
+	ZipOpenMember &open = ZipOpenMembers[rv->hidden.mem.base];
+	open.ctx = ctx;
+	open.member = member;
+	open.count += 1;
+	if (ctx) { ctx->openMembers += 1; }
+	if (member) { member->refs += 1; }
+	return rv;
+}
+
+/**
+ * Finds data of a member that is stored without compression in a memory mapped zip.
+ * @return Pointer into the map or NULL if the member needs decompression.
+ */
+static const void *findStoredZipMember(ZipContext *ctx, const mz_zip_archive_file_stat &stat)
+{
+	if (!ctx->map || stat.m_method != 0 || stat.m_is_encrypted || stat.m_comp_size != stat.m_uncomp_size)
+	{
+		return NULL;
+	}
+	const Uint8 *begin = (const Uint8 *)ctx->map;
+	const Uint8 *end = begin + ctx->mapSize;
+	const Uint8 *local = begin + stat.m_local_header_ofs;
+	// local file header: signature, fixed fields, then variable length name and extra field
+	const size_t localHeaderSize = 30;
+	if (stat.m_local_header_ofs + localHeaderSize > ctx->mapSize || local[0] != 'P' || local[1] != 'K' || local[2] != 3 || local[3] != 4)
+	{
+		return NULL;
+	}
+	size_t nameSize = local[26] | (local[27] << 8);
+	size_t extraSize = local[28] | (local[29] << 8);
+	const Uint8 *data = local + localHeaderSize + nameSize + extraSize;
+	if (data > end || (size_t)(end - data) < stat.m_uncomp_size)
+	{
+		return NULL;
+	}
+	return data;
+}
+
+/**
+ * Opens a member of a zip. Stored members of mapped zips are read in place,
+ * other members are decompressed once and kept in a cache shared by all readers.
+ * @param zip Zip archive.
+ * @param findex Index of the member.
+ * @return rwops with member data, or NULL on error.
+ */
+static SDL_RWops *openZipMember(mz_zip_archive *zip, mz_uint findex)
+{
+	ZipContext *ctx = (ZipContext *)zip;
+	std::lock_guard<std::mutex> lock(ZipMutex);
+
+	mz_zip_archive_file_stat stat;
+	if (!mz_zip_reader_file_stat(zip, findex, &stat))
+	{
+		SDL_SetError("miniz stat: %s", mz_zip_get_error_string(mz_zip_get_last_error(zip)));
+		return NULL;
+	}
+	if (const void *data = findStoredZipMember(ctx, stat))
+	{
+		return newZipMemberRWops(data, (size_t)stat.m_uncomp_size, ctx, NULL);
+	}
+
+	auto key = std::make_pair((const ZipContext*)ctx, findex);
+	auto i = ZipCache.find(key);
+	ZipMemberData *member;
+	if (i != ZipCache.end())
+	{
+		member = i->second;
+	}
+	else
+	{
+		size_t size;
+		void *data = mz_zip_reader_extract_to_heap(zip, findex, &size, 0);
+		if (data == NULL)
+		{
+			SDL_SetError("miniz extract: %s", mz_zip_get_error_string(mz_zip_get_last_error(zip)));
+			return NULL;
+		}
+		member = new ZipMemberData{ data, size, 0, 0, true };
+		ZipCache[key] = member;
+		ZipCacheSize += size;
+	}
+	member->lastUse = ++ZipCacheCounter;
+	SDL_RWops *rv = newZipMemberRWops(member->data, member->size, NULL, member);
+	trimZipCache();
+	return rv;
+}
+
+/**
+ * Decompresses a member of a zip to a new heap buffer, bypassing the cache.
+ * Mapped zips can be read from many threads at once.
+ * @param zip Zip archive.
+ * @param findex Index of the member.
+ * @param size Returns size of data.
+ * @return Data to be freed with mz_free, or NULL on error.
+ */
+static void *extractZipMember(mz_zip_archive *zip, mz_uint findex, size_t *size)
+{
+	ZipContext *ctx = (ZipContext *)zip;
+	if (ctx->map)
+	{
+		return mz_zip_reader_extract_to_heap(zip, findex, size, 0);
+	}
+	std::lock_guard<std::mutex> lock(ZipMutex);
+	return mz_zip_reader_extract_to_heap(zip, findex, size, 0);
+}
+
 FileRecord::FileRecord() : fullpath(""), zip(NULL), findex(0) { }
 
 SDL_RWops *FileRecord::getRWops() const
 {
 	SDL_RWops *rv;
 	if (zip != NULL) {
-		rv = SDL_RWFromMZ((mz_zip_archive *)zip, findex);
+		rv = openZipMember((mz_zip_archive *)zip, findex);
 	} else {
 		rv = SDL_RWFromFile(fullpath.c_str(), "rb");
 	}
@@ -254,7 +506,7 @@ SDL_RWops *FileRecord::getRWopsReadAll() const
 	SDL_RWops *rv;
 	if (zip != NULL)
 	{
-		rv = SDL_RWFromMZ((mz_zip_archive *)zip, findex);
+		rv = openZipMember((mz_zip_archive *)zip, findex);
 	}
 	else
 	{
@@ -296,7 +548,7 @@ std::unique_ptr<std::istream> FileRecord::getIStream() const
 {
 	if (zip != NULL) {
 		size_t size;
-		void *data = mz_zip_reader_extract_to_heap((mz_zip_archive *)zip, findex, &size, 0);
+		void *data = extractZipMember((mz_zip_archive *)zip, findex, &size);
 		if (data == NULL) {
 			auto err = "FileRecord::getIStream(): failed to decompress " + fullpath + ": ";
 			err += mz_zip_get_error_string(mz_zip_get_last_error((mz_zip_archive *)zip));
@@ -312,6 +564,40 @@ std::unique_ptr<std::istream> FileRecord::getIStream() const
 	}
 }
 
+/**
+ * Reads the whole file to memory. Errors are only thrown, never logged,
+ * as logger is not thread safe and this is used by worker threads.
+ * @return Stream with file content.
+ */
+std::unique_ptr<std::istream> FileRecord::readIStream() const
+{
+	size_t size = 0;
+	void *data;
+	if (zip != NULL)
+	{
+		data = extractZipMember((mz_zip_archive *)zip, findex, &size);
+		if (data == NULL)
+		{
+			throw Exception("FileRecord::readIStream(): failed to decompress " + fullpath);
+		}
+		auto rv = new std::stringstream(std::string((char *)data, size));
+		mz_free(data);
+		return std::unique_ptr<std::istream>(rv);
+	}
+	else
+	{
+		SDL_RWops *rw = SDL_RWFromFile(fullpath.c_str(), "rb");
+		data = rw ? SDL_LoadFile_RW(rw, &size, SDL_TRUE) : NULL;
+		if (data == NULL)
+		{
+			throw Exception("FileRecord::readIStream(): failed to read " + fullpath);
+		}
+		auto rv = new std::stringstream(std::string((char *)data, size));
+		SDL_free(data);
+		return std::unique_ptr<std::istream>(rv);
+	}
+}
+
 YAML::Node FileRecord::getYAML() const
 {
 	try
@@ -387,6 +673,7 @@ static bool isRuleset(const std::string& fname) {
 typedef std::unordered_map<std::string, FileRecord> FileSet;
 static const NameSet emptySet;
 static mz_zip_archive *newZipContext(const std::string& log_ctx, SDL_RWops *rwops);
+static mz_zip_archive *newZipContextMapped(const std::string& log_ctx, const std::string& path);
 
 struct VFSLayer {
 	std::string fullpath;				// the origin
@@ -448,12 +735,9 @@ struct VFSLayer {
 	*/
 	bool mapZipFile(const std::string& zippath, const std::string& prefix, bool ignore_ruls = false) {
 		std::string log_ctx = "mapZipFile(" + zippath + ",  '" + prefix + "',  '" + (ignore_ruls ? "true" : "false") + "'): ";
-		SDL_RWops *rwops = SDL_RWFromFile(zippath.c_str(), "r");
-		if (!rwops) {
-			Log(LOG_WARNING) << log_ctx << "Ignoring zip '" << zippath << "': " << SDL_GetError();
-			return false;
-		}
-		return mapZipFileRW(rwops, zippath, prefix, ignore_ruls);
+		mz_zip_archive *zip = newZipContextMapped(log_ctx, zippath);
+		if (!zip) { return false; }
+		return mapZip(zip, zippath, prefix, ignore_ruls);
 	}
 	/** maps a zipped moddir from an SDL_RWops
 	* @param rwops - SDL_RWops with the zip data
@@ -715,27 +999,51 @@ struct VFS {
 static std::unordered_map<std::string, ModRecord *> ModsAvailable;
 static std::unordered_set<VFSLayer *> MappedVFSLayers; // owned here so we can have some sense of their lifetime
 												       // only the layers that get dropped on FileMap::clear()
-static std::vector<mz_zip_archive *> ZipContexts;	   // zip decompression contexts shared between layers that came from
-													   // the same .zip. this makes the whole thing very thread-unsafe
+static std::vector<ZipContext *> ZipContexts;		   // zip decompression contexts shared between layers that came from
+													   // the same .zip. access to them is guarded by ZipMutex
 static VFS TheVFS;
 
 const RSOrder &getRulesets() { return TheVFS.get_rulesets(); }
 
 static mz_zip_archive *newZipContext(const std::string& log_ctx, SDL_RWops *rwops) {
-	mz_zip_archive *zip = (mz_zip_archive *) SDL_malloc(sizeof(mz_zip_archive));
-	if (!zip) {
-		Log(LOG_FATAL) << log_ctx << ": " << SDL_GetError();
-		throw Exception("Out of memory");
-	}
-	if (!mz_zip_reader_init_rwops(zip, rwops)) {
+	ZipContext *ctx = new ZipContext();
+	if (!mz_zip_reader_init_rwops(&ctx->zip, rwops)) {
 		// whoa, no opening the file
-		Log(LOG_WARNING) << log_ctx << "Ignoring zip: " << mz_zip_get_error_string(mz_zip_get_last_error(zip));
+		Log(LOG_WARNING) << log_ctx << "Ignoring zip: " << mz_zip_get_error_string(mz_zip_get_last_error(&ctx->zip));
 		SDL_RWclose(rwops);
-		SDL_free(zip);
+		delete ctx;
+		return NULL;
+	}
+	ZipContexts.push_back(ctx);
+	return &ctx->zip;
+}
+/** Opens a .zip from filesystem, memory mapped if possible.
+ * @param log_ctx - prefix for log messages
+ * @param path - path to the .zip
+ * @return - zip context or NULL if failed to open
+ */
+static mz_zip_archive *newZipContextMapped(const std::string& log_ctx, const std::string& path) {
+	size_t size = 0;
+	const void *map = CrossPlatform::mapFile(path, &size);
+	if (!map) {
+		SDL_RWops *rwops = SDL_RWFromFile(path.c_str(), "r");
+		if (!rwops) {
+			Log(LOG_WARNING) << log_ctx << "Ignoring zip '" << path << "': " << SDL_GetError();
+			return NULL;
+		}
+		return newZipContext(log_ctx, rwops);
+	}
+	ZipContext *ctx = new ZipContext();
+	ctx->map = map;
+	ctx->mapSize = size;
+	if (!mz_zip_reader_init_mem(&ctx->zip, map, size, 0)) {
+		Log(LOG_WARNING) << log_ctx << "Ignoring zip: " << mz_zip_get_error_string(mz_zip_get_last_error(&ctx->zip));
+		CrossPlatform::unmapFile(map, size);
+		delete ctx;
 		return NULL;
 	}
-	ZipContexts.push_back(zip);
-	return zip;
+	ZipContexts.push_back(ctx);
+	return &ctx->zip;
 }
 
 void clear(bool clearOnly, bool embeddedOnly) {
@@ -744,8 +1052,21 @@ void clear(bool clearOnly, bool embeddedOnly) {
 	ModsAvailable.clear();
 	for (auto i : MappedVFSLayers ) { delete i; }
 	MappedVFSLayers.clear();
-	for (auto i : ZipContexts) { mz_zip_reader_end_rwops(i); SDL_free(i); }
-	ZipContexts.clear();
+	{
+		// members still open keep their data, the rest is freed now
+		std::lock_guard<std::mutex> lock(ZipMutex);
+		for (auto &i : ZipCache) {
+			i.second->cached = false;
+			if (i.second->refs == 0) { freeZipMember(i.second); }
+		}
+		ZipCache.clear();
+		ZipCacheSize = 0;
+		for (auto i : ZipContexts) {
+			if (i->openMembers == 0) { destroyZipContext(i); }
+			else { i->closed = true; }
+		}
+		ZipContexts.clear();
+	}
 	if (!clearOnly)
 	{
 		Log(LOG_VERBOSE) << "FileMap::clear(): mapping 'common'";
@@ -927,14 +1248,12 @@ static void mapZippedMod(mz_zip_archive *zip, const std::string& zipfname, const
 	mrec->push_back(layer);
 	ModsAvailable.insert(std::make_pair(mrec->modInfo.getId(), mrec));
 }
-/** now this scans a zip of mods or of a single mod
- * @param rwops - SDL_RWops to the zip data
+/** scans an opened zip of mods or of a single mod
+ * @param mzip - opened zip, can be NULL
  * @param fullpath - full path to associate with the .zip.
+ * @param log_ctx - prefix for log messages
  */
-void scanModZipRW(SDL_RWops *rwops, const std::string& fullpath) {
-	std::string log_ctx = "scanModZipRW(rwops, " + fullpath + "): ";
-	mz_zip_archive *mzip = newZipContext(log_ctx, rwops);
-
+static void scanModZipContext(mz_zip_archive *mzip, const std::string& fullpath, const std::string& log_ctx) {
 	if (!mzip) { return; }
 	// check if this is maybe a zip of a single mod (metadata.yml at the top level)
 	if (mz_zip_reader_locate_file_v2(mzip, "metadata.yml", NULL, 0, NULL)) {
@@ -958,17 +1277,20 @@ void scanModZipRW(SDL_RWops *rwops, const std::string& fullpath) {
 		mapZippedMod(mzip, fullpath, prefix);
 	}
 }
+/** now this scans a zip of mods or of a single mod
+ * @param rwops - SDL_RWops to the zip data
+ * @param fullpath - full path to associate with the .zip.
+ */
+void scanModZipRW(SDL_RWops *rwops, const std::string& fullpath) {
+	std::string log_ctx = "scanModZipRW(rwops, " + fullpath + "): ";
+	scanModZipContext(newZipContext(log_ctx, rwops), fullpath, log_ctx);
+}
 /** Filesystem wrapper for scanModZipRW()
  * @param fullpath - full path to the .zip.
  */
 void scanModZip(const std::string& fullpath) {
 	std::string log_ctx = "scanModZip(" + fullpath + "): ";
-	SDL_RWops *rwops = SDL_RWFromFile(fullpath.c_str(), "r");
-	if (!rwops) {
-		Log(LOG_WARNING) << log_ctx << "Ignoring zip: " << SDL_GetError();
-		return;
-	}
-	scanModZipRW(rwops, fullpath);
+	scanModZipContext(newZipContextMapped(log_ctx, fullpath), fullpath, log_ctx);
 }
 /**
  * Extracts a single file to an ConstMem RWops object
@@ -51,6 +51,8 @@ namespace FileMap
 		SDL_RWops *getRWopsReadAll() const;
 
 		std::unique_ptr<std::istream> getIStream() const;
+		/// Read the whole file to memory without logging errors, safe to call from worker threads.
+		std::unique_ptr<std::istream> readIStream() const;
 		YAML::Node getYAML() const;
 		std::vector<YAML::Node> getAllYAML() const;
 	};
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include "FrameTrace.h"
+#include "CrossPlatform.h"
+#include "Options.h"
+#include "Logger.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+/**
+ * One slot of ring buffer.
+ * `seq` is zero while slot is written, otherwise it is index of event plus one,
+ * this allow export to skip events that were overwritten while reading them.
+ */
+struct FrameTraceSlot
+{
+	std::atomic<Uint64> seq;
+	std::atomic<const char*> name;
+	std::atomic<Uint64> begin;
+	std::atomic<Uint64> end;
+	std::atomic<Uint32> thread;
+};
+
+/// Copy of event taken from buffer.
+struct FrameTraceEvent
+{
+	const char *name;
+	Uint64 begin;
+	Uint64 end;
+	Uint32 thread;
+};
+
+std::unique_ptr<FrameTraceSlot[]> traceSlots;
+Uint64 traceSize = 0;
+std::atomic<Uint64> traceNext(0);
+std::atomic<Uint32> traceThreads(0);
+const std::chrono::steady_clock::time_point traceStart = std::chrono::steady_clock::now();
+
+/**
+ * Gets small number identifying current thread, first thread that record anything get zero.
+ */
+Uint32 getTraceThread()
+{
+	thread_local Uint32 id = traceThreads.fetch_add(1, std::memory_order_relaxed);
+	return id;
+}
+
+/**
+ * Copies all complete events still in buffer, oldest first.
+ */
+std::vector<FrameTraceEvent> collectEvents()
+{
+	std::vector<FrameTraceEvent> events;
+	const Uint64 last = traceNext.load(std::memory_order_acquire);
+	const Uint64 first = last > traceSize ? last - traceSize : 0;
+	events.reserve(last - first);
+	for (Uint64 i = first; i < last; ++i)
+	{
+		FrameTraceSlot &slot = traceSlots[i & (traceSize - 1)];
+		const Uint64 seq = slot.seq.load(std::memory_order_acquire);
+		if (seq != i + 1)
+		{
+			continue;
+		}
+		FrameTraceEvent e;
+		e.name = slot.name.load(std::memory_order_relaxed);
+		e.begin = slot.begin.load(std::memory_order_relaxed);
+		e.end = slot.end.load(std::memory_order_relaxed);
+		e.thread = slot.thread.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.seq.load(std::memory_order_relaxed) != seq)
+		{
+			continue;
+		}
+		events.push_back(e);
+	}
+	return events;
+}
+
+}//namespace
+
+bool FrameTrace::_enabled = false;
+
+/**
+ * Allocates ring buffer, size is rounded up to power of two.
+ * Need be called before any thread start recording.
+ * @param events Number of last events to keep.
+ */
+void FrameTrace::init(int events)
+{
+	_enabled = events > 0;
+	if (!_enabled)
+	{
+		return;
+	}
+
+	traceSize = 1024;
+	while (traceSize < (Uint64)events && traceSize < (1u << 24))
+	{
+		traceSize *= 2;
+	}
+	traceSlots.reset(new FrameTraceSlot[traceSize]);
+	for (Uint64 i = 0; i < traceSize; ++i)
+	{
+		traceSlots[i].seq.store(0, std::memory_order_relaxed);
+	}
+	traceNext.store(0, std::memory_order_release);
+	Log(LOG_INFO) << "Frame trace enabled, keeping last " << traceSize << " events.";
+}
+
+/**
+ * Gets time since start of program.
+ * @return Time in nanoseconds.
+ */
+Uint64 FrameTrace::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceStart).count();
+}
+
+/**
+ * Adds event to buffer, overwriting oldest one if buffer is full.
+ * @param name Name of event, need be string literal.
+ * @param begin Start time in nanoseconds.
+ * @param end End time in nanoseconds.
+ */
+void FrameTrace::record(const char *name, Uint64 begin, Uint64 end)
+{
+	const Uint64 index = traceNext.fetch_add(1, std::memory_order_relaxed);
+	FrameTraceSlot &slot = traceSlots[index & (traceSize - 1)];
+	slot.seq.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.begin.store(begin, std::memory_order_relaxed);
+	slot.end.store(end, std::memory_order_relaxed);
+	slot.thread.store(getTraceThread(), std::memory_order_relaxed);
+	slot.seq.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * Saves events as complete ("X") events of Chrome trace format.
+ * @param filename Path of file.
+ * @return True on success.
+ */
+bool FrameTrace::exportJson(const std::string &filename)
+{
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(3);
+	out << "{\"traceEvents\":[\n";
+	bool first = true;
+	for (auto& e : collectEvents())
+	{
+		if (!first)
+		{
+			out << ",\n";
+		}
+		first = false;
+		out << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread;
+		out << ",\"ts\":" << e.begin / 1000.0 << ",\"dur\":" << (e.end - e.begin) / 1000.0 << "}";
+	}
+	out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return CrossPlatform::writeFile(filename, out.str());
+}
+
+/**
+ * Saves events as CSV, times are in microseconds.
+ * @param filename Path of file.
+ * @return True on success.
+ */
+bool FrameTrace::exportCsv(const std::string &filename)
+{
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(3);
+	out << "name,thread,begin,duration\n";
+	for (auto& e : collectEvents())
+	{
+		out << e.name << "," << e.thread << "," << e.begin / 1000.0 << "," << (e.end - e.begin) / 1000.0 << "\n";
+	}
+	return CrossPlatform::writeFile(filename, out.str());
+}
+
+/**
+ * Saves current content of buffer to user folder.
+ */
+void FrameTrace::save()
+{
+	if (!_enabled)
+	{
+		return;
+	}
+	const std::string json = Options::getUserFolder() + "frameTrace.json";
+	const std::string csv = Options::getUserFolder() + "frameTrace.csv";
+	if (exportJson(json) && exportCsv(csv))
+	{
+		Log(LOG_INFO) << "Frame trace saved to " << json << " and " << csv;
+	}
+}
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <SDL_types.h>
+
+namespace OpenXcom
+{
+
+/**
+ * Records timings of marked sections of code into fixed size ring buffer.
+ * Any thread can record without locking, old events are overwritten by new ones.
+ * Content of buffer can be saved as Chrome trace JSON (chrome://tracing) or CSV.
+ */
+class FrameTrace
+{
+	static bool _enabled;
+public:
+	/// Allocates buffer for given number of events, zero disables tracing.
+	static void init(int events);
+	/// Is tracing enabled?
+	static bool isEnabled() { return _enabled; }
+	/// Gets current time in nanoseconds.
+	static Uint64 now();
+	/// Adds event to buffer.
+	static void record(const char *name, Uint64 begin, Uint64 end);
+	/// Saves recorded events as Chrome trace JSON.
+	static bool exportJson(const std::string &filename);
+	/// Saves recorded events as CSV.
+	static bool exportCsv(const std::string &filename);
+	/// Saves recorded events in both formats to user folder.
+	static void save();
+};
+
+/**
+ * Records time spent in current scope when tracing is enabled.
+ * Name need to be string literal, only pointer to it is stored.
+ */
+class FrameTraceScope
+{
+	const char *_name;
+	Uint64 _begin;
+public:
+	/// Starts timing of scope.
+	FrameTraceScope(const char *name) : _name(FrameTrace::isEnabled() ? name : nullptr), _begin(_name ? FrameTrace::now() : 0) { }
+	/// Records time spent in scope.
+	~FrameTraceScope() { stop(); }
+	/// Records time spent from start of scope up to now, later calls do nothing.
+	void stop() { if (_name) { FrameTrace::record(_name, _begin, FrameTrace::now()); _name = nullptr; } }
+
+	FrameTraceScope(const FrameTraceScope&) = delete;
+	FrameTraceScope& operator=(const FrameTraceScope&) = delete;
+};
+
+}
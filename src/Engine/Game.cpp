@@ -31,15 +31,19 @@
 #include "../Interface/Cursor.h"
 #include "../Interface/FpsCounter.h"
 #include "../Mod/Mod.h"
+#include "../Mod/RuleInterface.h"
 #include "../Savegame/SavedGame.h"
 #include "../Savegame/SavedBattleGame.h"
+#include "../Savegame/BackgroundSaver.h"
 #include "Action.h"
 #include "Exception.h"
 #include "Options.h"
 #include "CrossPlatform.h"
 #include "FileMap.h"
+#include "FrameTrace.h"
 #include "Unicode.h"
 #include "../Menu/NotesState.h"
+#include "../Menu/ErrorMessageState.h"
 #include "../Menu/TestState.h"
 #include <algorithm>
 #include "../fallthrough.h"
@@ -108,6 +112,7 @@ Game::Game(const std::string &title) : _screen(0), _cursor(0), _lang(0), _save(0
 
 	// Create fps counter
 	_fpsCounter = new FpsCounter(15, 5, 0, 0);
+	FrameTrace::init(Options::oxceFrameTrace);
 
 	// Create blank language
 	_lang = new Language();
@@ -156,6 +161,8 @@ void Game::run()
 	bool startupEvent = Options::allowResize;
 	while (!_quit)
 	{
+		FrameTraceScope traceFrame("Game::frame");
+
 		// Clean up states
 		while (!_deleted.empty())
 		{
@@ -184,6 +191,7 @@ void Game::run()
 		}
 
 		// Process events
+		FrameTraceScope traceEvents("Game::events");
 		while (SDL_PollEvent(&_event))
 		{
 			if (CrossPlatform::isQuitShortcut(_event))
@@ -271,6 +279,11 @@ void Game::run()
 							Options::captureMouse = (SDL_GrabMode)(!Options::captureMouse);
 							SDL_WM_GrabInput(Options::captureMouse);
 						}
+						// "ctrl-F11" save frame trace
+						else if (action.getDetails()->key.keysym.sym == SDLK_F11 && isCtrlPressed() && FrameTrace::isEnabled())
+						{
+							FrameTrace::save();
+						}
 						// "ctrl-n" notes UI
 						else if (action.getDetails()->key.keysym.sym == SDLK_n && isCtrlPressed())
 						{
@@ -313,13 +326,17 @@ void Game::run()
 				break;
 			}
 		}
+		traceEvents.stop();
 
 		// Process rendering
 		if (runningState != PAUSED)
 		{
 			// Process logic
+			FrameTraceScope traceThink("State::think");
 			_states.back()->think();
 			_fpsCounter->think();
+			reportBackgroundSave();
+			traceThink.stop();
 			if (Options::FPS > 0 && !(Options::useOpenGL && Options::vSyncForOpenGL))
 			{
 				// Update our FPS delay time based on the time of the last draw.
@@ -337,6 +354,7 @@ void Game::run()
 				// make a note of when this frame update occurred.
 				_timeOfLastFrame = SDL_GetTicks();
 				_fpsCounter->addFrame();
+				FrameTraceScope traceBlit("State::blit");
 				_screen->clear();
 				std::list<State*>::iterator i = _states.end();
 				do
@@ -351,6 +369,8 @@ void Game::run()
 				}
 				_fpsCounter->blit(_screen->getSurface());
 				_cursor->blit(_screen->getSurface());
+				traceBlit.stop();
+				FrameTraceScope traceFlip("Screen::flip");
 				_screen->flip();
 			}
 		}
@@ -369,6 +389,31 @@ void Game::run()
 	Options::save();
 }
 
+/**
+ * Checks if the last background save failed, and tells the player right away
+ * instead of waiting for the next save.
+ */
+void Game::reportBackgroundSave()
+{
+	std::string error = BackgroundSaver::getInstance().takeError();
+	if (error.empty())
+	{
+		return;
+	}
+	Log(LOG_ERROR) << error;
+	if (!_mod || _states.empty())
+	{
+		return;
+	}
+	std::ostringstream msg;
+	msg << _lang->getString("STR_SAVE_UNSUCCESSFUL") << Unicode::TOK_NL_SMALL << error;
+	RuleInterface *errors = _mod->getInterface("errorMessages");
+	if (_save && _save->getSavedBattle())
+		pushState(new ErrorMessageState(msg.str(), _states.back()->getPalette(), errors->getElement("battlescapeColor")->color, "TAC00.SCR", errors->getElement("battlescapePalette")->color));
+	else
+		pushState(new ErrorMessageState(msg.str(), _states.back()->getPalette(), errors->getElement("geoscapeColor")->color, "BACK01.SCR", errors->getElement("geoscapePalette")->color));
+}
+
 /**
  * Stops the state machine and the game is shut down.
  */
@@ -58,6 +58,9 @@ private:
 	bool _ctrl, _alt, _shift, _rmb, _mmb;
 	static const double VOLUME_GRADIENT;
 
+	/// Shows the error of a failed background save.
+	void reportBackgroundSave();
+
 public:
 	double mouseScaleXMul;
 	double mouseScaleYMul;
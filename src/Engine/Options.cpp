@@ -242,6 +242,20 @@ void create()
 	_info.push_back(OptionInfo("oxceListVFSContents", &oxceListVFSContents, false));
 	_info.push_back(OptionInfo("oxceRawScreenShots", &oxceRawScreenShots, false));
 	_info.push_back(OptionInfo("oxceThumbButtons", &oxceThumbButtons, true));
+	_info.push_back(OptionInfo("oxceWorkerThreads", &oxceWorkerThreads, 0));
+	_info.push_back(OptionInfo("oxceThreadedFov", &oxceThreadedFov, false));
+	_info.push_back(OptionInfo("oxceThreadedAI", &oxceThreadedAI, false));
+	_info.push_back(OptionInfo("oxceBenchmarkBlit", &oxceBenchmarkBlit, false));
+	_info.push_back(OptionInfo("oxceBenchmarkScripts", &oxceBenchmarkScripts, false));
+	_info.push_back(OptionInfo("oxceScriptProfiler", &oxceScriptProfiler, 0));
+	_info.push_back(OptionInfo("oxceRulesetCache", &oxceRulesetCache, false));
+	_info.push_back(OptionInfo("oxceThreadedLoading", &oxceThreadedLoading, true));
+	_info.push_back(OptionInfo("oxceBinarySaves", &oxceBinarySaves, false));
+	_info.push_back(OptionInfo("oxceBackgroundAutosave", &oxceBackgroundAutosave, true));
+	_info.push_back(OptionInfo("oxceLazyLoadBudget", &oxceLazyLoadBudget, 64));
+	_info.push_back(OptionInfo("oxceGlobeLandCache", &oxceGlobeLandCache, true));
+	_info.push_back(OptionInfo("oxceRecolorCache", &oxceRecolorCache, 0));
+	_info.push_back(OptionInfo("oxceFrameTrace", &oxceFrameTrace, 0));
 
 	_info.push_back(OptionInfo("oxceRecommendedOptionsWereSet", &oxceRecommendedOptionsWereSet, false));
 	_info.push_back(OptionInfo("password", &password, "secret"));
@@ -88,6 +88,20 @@ OPT bool oxceEmbeddedOnly;
 OPT bool oxceListVFSContents;
 OPT bool oxceRawScreenShots;
 OPT bool oxceThumbButtons;
+OPT int oxceWorkerThreads;
+OPT bool oxceThreadedFov;
+OPT bool oxceThreadedAI;
+OPT bool oxceBenchmarkBlit;
+OPT bool oxceBenchmarkScripts;
+OPT int oxceScriptProfiler;
+OPT bool oxceRulesetCache;
+OPT bool oxceThreadedLoading;
+OPT bool oxceBinarySaves;
+OPT bool oxceBackgroundAutosave;
+OPT int oxceLazyLoadBudget;
+OPT bool oxceGlobeLandCache;
+OPT int oxceRecolorCache;
+OPT int oxceFrameTrace;
 
 OPT bool oxceRecommendedOptionsWereSet;
 OPT std::string password;
@@ -24,9 +24,14 @@
 #include <cmath>
 #include <bitset>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <unordered_map>
 
 #include "Logger.h"
 #include "Options.h"
+#include "CrossPlatform.h"
 #include "Script.h"
 #include "ScriptBind.h"
 #include "Surface.h"
@@ -65,6 +70,36 @@ namespace OpenXcom
 	MACRO_COPY_64(Func, (Pos) + 0x80) \
 	MACRO_COPY_64(Func, (Pos) + 0xC0)
 
+/**
+ * Same as MACRO_COPY_256 but position is passed as two hex digits, this allow creating unique names for each position.
+ */
+#define MACRO_COPY_HEX_16(Func, H) \
+	Func(H, 0) Func(H, 1) Func(H, 2) Func(H, 3) \
+	Func(H, 4) Func(H, 5) Func(H, 6) Func(H, 7) \
+	Func(H, 8) Func(H, 9) Func(H, A) Func(H, B) \
+	Func(H, C) Func(H, D) Func(H, E) Func(H, F)
+#define MACRO_COPY_HEX_256(Func) \
+	MACRO_COPY_HEX_16(Func, 0) MACRO_COPY_HEX_16(Func, 1) MACRO_COPY_HEX_16(Func, 2) MACRO_COPY_HEX_16(Func, 3) \
+	MACRO_COPY_HEX_16(Func, 4) MACRO_COPY_HEX_16(Func, 5) MACRO_COPY_HEX_16(Func, 6) MACRO_COPY_HEX_16(Func, 7) \
+	MACRO_COPY_HEX_16(Func, 8) MACRO_COPY_HEX_16(Func, 9) MACRO_COPY_HEX_16(Func, A) MACRO_COPY_HEX_16(Func, B) \
+	MACRO_COPY_HEX_16(Func, C) MACRO_COPY_HEX_16(Func, D) MACRO_COPY_HEX_16(Func, E) MACRO_COPY_HEX_16(Func, F)
+
+/**
+ * GCC and Clang support labels as values, each operation can jump directly to next one (direct threaded code).
+ * Define OXCE_SCRIPT_SWITCH_DISPATCH to force portable `switch` version.
+ */
+#if defined(__GNUC__) && !defined(OXCE_SCRIPT_SWITCH_DISPATCH)
+#define OXCE_SCRIPT_THREADED_DISPATCH
+// table of label addresses is static, copies of function would jump to labels of original one.
+#ifdef __clang__
+#define OXCE_SCRIPT_EXE_ATTRIBUTES __attribute__((noinline))
+#else
+#define OXCE_SCRIPT_EXE_ATTRIBUTES __attribute__((noinline, noclone))
+#endif
+#else
+#define OXCE_SCRIPT_EXE_ATTRIBUTES inline
+#endif
+
 
 ////////////////////////////////////////////////////////////
 //						proc definition
@@ -197,6 +232,7 @@ static inline RetEnum bit_popcount_h(int& reg)
 	\
 	IMPL(aggregate,	MACRO_QUOTE({ Reg0 = Reg0 + Data1 * Data2;						return RetContinue; }),		(int& Reg0, int Data1, int Data2),			"arg1 = arg1 + (arg2 * arg3)") \
 	IMPL(offset,	MACRO_QUOTE({ Reg0 = Reg0 * Data1 + Data2;						return RetContinue; }),		(int& Reg0, int Data1, int Data2),			"arg1 = (arg1 * arg2) + arg3") \
+	IMPL(set_add,	MACRO_QUOTE({ Reg0 = Data1 + Data2;								return RetContinue; }),		(int& Reg0, int Data1, int Data2),			"arg1 = arg2 + arg3") \
 	IMPL(offsetmod,	MACRO_QUOTE({ return mulAddMod_h(Reg0, Mul1, Add2, Mod3);							}),		(int& Reg0, int Mul1, int Add2, int Mod3),	"arg1 = ((arg1 * arg2) + arg3) % arg4") \
 	\
 	IMPL(div,		MACRO_QUOTE({ if (!Data1) return RetError; Reg0 /= Data1;					return RetContinue; }),		(int& Reg0, int Data1),		"arg1 = arg1 / arg2") \
@@ -383,18 +419,20 @@ enum ProcEnum : Uint8
 /**
  * Core function in script engine used to executing scripts
  * @param proc array storing operation of script
+ * @param ops when Profile is set, increased by number of executed operations
  * @return Result of executing script
  */
-static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
+template<bool Profile>
+static OXCE_SCRIPT_EXE_ATTRIBUTES void scriptExeImpl(ScriptWorkerBase& data, const Uint8* proc, Uint64& ops)
 {
 	ProgPos curr = ProgPos::Start;
 	//--------------------------------------------------
 	//			helper macros for this function
 	//--------------------------------------------------
 	#define MACRO_FUNC_ARRAY(NAME, ...) + helper::FuncGroup<MACRO_FUNC_ID(NAME)>::FuncList{}
-	#define MACRO_FUNC_ARRAY_LOOP(POS) \
-		case (POS): \
+	#define MACRO_FUNC_BODY(POS, NEXT) \
 		{ \
+			if (Profile) ++ops; \
 			using currType = helper::GetType<func, POS>; \
 			const auto p = proc + (int)curr; \
 			curr += currType::offset; \
@@ -410,12 +448,33 @@ static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
 				} \
 			} \
 			else \
-				continue; \
+				NEXT; \
 		}
+#ifdef OXCE_SCRIPT_THREADED_DISPATCH
+	#define MACRO_FUNC_NEXT goto *labels[proc[(int)curr++]]
+	#define MACRO_FUNC_LABEL_ADDRESS(H, L) &&op_##H##L,
+	#define MACRO_FUNC_LABEL_LOOP(H, L) \
+		op_##H##L: \
+		MACRO_FUNC_BODY(0x##H##L, MACRO_FUNC_NEXT)
+#else
+	#define MACRO_FUNC_ARRAY_LOOP(POS) \
+		case (POS): \
+		MACRO_FUNC_BODY(POS, continue)
+#endif
 	//--------------------------------------------------
 
 	using func = decltype(MACRO_PROC_DEFINITION(MACRO_FUNC_ARRAY));
 
+#ifdef OXCE_SCRIPT_THREADED_DISPATCH
+	static const void* const labels[256] =
+	{
+		MACRO_COPY_HEX_256(MACRO_FUNC_LABEL_ADDRESS)
+	};
+
+	MACRO_FUNC_NEXT;
+
+	MACRO_COPY_HEX_256(MACRO_FUNC_LABEL_LOOP)
+#else
 	while (true)
 	{
 		switch (proc[(int)curr++])
@@ -423,11 +482,19 @@ static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
 		MACRO_COPY_256(MACRO_FUNC_ARRAY_LOOP, 0)
 		}
 	}
+#endif
 
 	//--------------------------------------------------
 	//			removing helper macros
 	//--------------------------------------------------
+#ifdef OXCE_SCRIPT_THREADED_DISPATCH
+	#undef MACRO_FUNC_LABEL_LOOP
+	#undef MACRO_FUNC_LABEL_ADDRESS
+	#undef MACRO_FUNC_NEXT
+#else
 	#undef MACRO_FUNC_ARRAY_LOOP
+#endif
+	#undef MACRO_FUNC_BODY
 	#undef MACRO_FUNC_ARRAY
 	//--------------------------------------------------
 
@@ -442,11 +509,227 @@ static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
 	return;
 }
 
+namespace
+{
+
+/**
+ * Statistics of one script.
+ */
+struct ScriptProfileEntry
+{
+	const ScriptGlobal* shared;
+	std::string hook;
+	std::string rule;
+	std::string mod;
+	std::atomic<Uint64> calls{ 0 };
+	std::atomic<Uint64> ops{ 0 };
+	std::atomic<Uint64> time{ 0 };
+};
+
+/// All registered scripts, list do not move its elements.
+std::list<ScriptProfileEntry> profileEntries;
+/// Script code to its statistics.
+std::unordered_map<const Uint8*, ScriptProfileEntry*> profileIndex;
+/// Statistics of scripts that were not registered.
+ScriptProfileEntry profileUnknown{ nullptr, "unknown", "unknown", "unknown" };
+
+} // namespace
+
+/**
+ * Execute script measuring its time and number of operations.
+ * Scripts can run on worker threads, all counters are atomic.
+ * @param proc array storing operation of script
+ */
+static void scriptExeProfile(ScriptWorkerBase& data, const Uint8* proc)
+{
+	Uint64 ops = 0;
+	const auto start = std::chrono::steady_clock::now();
+	scriptExeImpl<true>(data, proc, ops);
+	const auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	auto it = profileIndex.find(proc);
+	auto& entry = it != profileIndex.end() ? *it->second : profileUnknown;
+	entry.calls.fetch_add(1, std::memory_order_relaxed);
+	entry.ops.fetch_add(ops, std::memory_order_relaxed);
+	entry.time.fetch_add(time, std::memory_order_relaxed);
+}
+
+/**
+ * Execute script, when profiling is disabled only cost is one check of option.
+ * @param proc array storing operation of script
+ */
+static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
+{
+	if (Options::oxceScriptProfiler)
+	{
+		scriptExeProfile(data, proc);
+	}
+	else
+	{
+		Uint64 ops = 0;
+		scriptExeImpl<false>(data, proc, ops);
+	}
+}
+
+/**
+ * Register script code, results will be attributed to its hook, rule and mod.
+ * @param shared global script data that own this script.
+ * @param script parsed script.
+ * @param hook name of script parser.
+ * @param rule name of rule that script belong to.
+ */
+void ScriptProfiler::add(const ScriptGlobal* shared, const ScriptContainerBase& script, const std::string& hook, const std::string& rule)
+{
+	if (script)
+	{
+		profileEntries.emplace_back();
+		auto& entry = profileEntries.back();
+		entry.shared = shared;
+		entry.hook = hook;
+		entry.rule = rule;
+		entry.mod = shared ? shared->getModName() : "";
+		profileIndex[script.data()] = &entry;
+	}
+}
+
+/**
+ * Forget all scripts registered by given global data, its scripts code will be freed.
+ * @param shared global script data.
+ */
+void ScriptProfiler::remove(const ScriptGlobal* shared)
+{
+	for (auto it = profileIndex.begin(); it != profileIndex.end(); )
+	{
+		if (it->second->shared == shared)
+		{
+			it = profileIndex.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+	profileEntries.remove_if([&](const ScriptProfileEntry& e) { return e.shared == shared; });
+}
+
+/**
+ * Forget script code that is going to be freed, new code could be allocated at same address
+ * and its statistics would be attributed to wrong script.
+ * @param script script container that is destroyed or overridden.
+ */
+void ScriptProfiler::remove(const ScriptContainerBase& script)
+{
+	if (script && !profileIndex.empty())
+	{
+		profileIndex.erase(script.data());
+	}
+}
+
+/**
+ * Log scripts sorted by time spent in them, optionally save all of them as CSV, and reset statistics.
+ * @param csvFile path of CSV file, empty to only log.
+ */
+void ScriptProfiler::report(const std::string& csvFile)
+{
+	const size_t logLimit = 20;
+
+	std::vector<ScriptProfileEntry*> used;
+	for (auto& e : profileEntries)
+	{
+		if (e.calls)
+		{
+			used.push_back(&e);
+		}
+	}
+	if (profileUnknown.calls)
+	{
+		used.push_back(&profileUnknown);
+	}
+	std::sort(used.begin(), used.end(), [](const ScriptProfileEntry* a, const ScriptProfileEntry* b) { return a->time > b->time; });
+
+	Uint64 total = 0;
+	for (auto* e : used)
+	{
+		total += e->time;
+	}
+	Log(LOG_INFO) << "Script profile: " << used.size() << " scripts run for " << total / 1000000 << " ms";
+	for (size_t i = 0; i < used.size() && i < logLimit; ++i)
+	{
+		const auto* e = used[i];
+		Log(LOG_INFO) << "  " << e->hook << " of '" << e->rule << "' from '" << e->mod << "': "
+			<< e->calls << " calls, " << e->ops << " ops, " << e->time / 1000 << " us, " << e->time / e->calls << " ns per call";
+	}
+
+	if (!csvFile.empty())
+	{
+		std::ostringstream csv;
+		auto field = [&](const std::string& value, char end)
+		{
+			// quote every field, quotes inside are doubled
+			csv << '"';
+			for (char c : value)
+			{
+				if (c == '"')
+				{
+					csv << '"';
+				}
+				csv << c;
+			}
+			csv << '"' << end;
+		};
+		field("hook", ','); field("rule", ','); field("mod", ','); field("calls", ','); field("ops", ','); field("time_ns", '\n');
+		for (auto* e : used)
+		{
+			field(e->hook, ',');
+			field(e->rule, ',');
+			field(e->mod, ',');
+			field(std::to_string(e->calls.load()), ',');
+			field(std::to_string(e->ops.load()), ',');
+			field(std::to_string(e->time.load()), '\n');
+		}
+		if (CrossPlatform::writeFile(csvFile, csv.str()))
+		{
+			Log(LOG_INFO) << "Script profile saved to " << csvFile;
+		}
+	}
+
+	for (auto* e : used)
+	{
+		e->calls = 0;
+		e->ops = 0;
+		e->time = 0;
+	}
+}
+
 
 ////////////////////////////////////////////////////////////
 //						Script class
 ////////////////////////////////////////////////////////////
 
+/**
+ * Destructor, script code is freed so profiler need forget it.
+ */
+ScriptContainerBase::~ScriptContainerBase()
+{
+	ScriptProfiler::remove(*this);
+}
+
+/**
+ * Move, current script code is freed so profiler need forget it.
+ */
+ScriptContainerBase &ScriptContainerBase::operator=(ScriptContainerBase&& other)
+{
+	if (this != &other)
+	{
+		ScriptProfiler::remove(*this);
+		_proc = std::move(other._proc);
+		_paramUsed = other._paramUsed;
+		_objectParamUsed = other._objectParamUsed;
+		_sideEffects = other._sideEffects;
+	}
+	return *this;
+}
+
 void ScriptWorkerBlit::executeBlit(Surface* src, Surface* dest, int x, int y, int shade)
 {
 	executeBlit(src, dest, x, y, shade, GraphSubset{ dest->getWidth(), dest->getHeight() });
@@ -460,73 +743,304 @@ void ScriptWorkerBlit::executeBlit(Surface* src, Surface* dest, int x, int y, in
  */
 void ScriptWorkerBlit::executeBlit(Surface* src, Surface* dest, int x, int y, int shade, GraphSubset mask)
 {
+	if (_proc)
+	{
+		executeBlitScript(src, dest, x, y, mask);
+	}
+	else
+	{
 		ShaderMove<Uint8> srcShader(src, x, y);
 		ShaderMove<Uint8> destShader(dest, 0, 0);
 
 		destShader.setDomain(mask);
 
-		if (_proc)
+		ShaderDrawRow<helper::StandardShade>(destShader, srcShader, ShaderScalar(shade));
+	}
+}
+
+/**
+ * Run blit scripts for each non transparent pixel of source.
+ * When scripts depend only on source pixel, they are run once for each color used by source
+ * and result is applied as lookup table.
+ * @param src source surface.
+ * @param dest destination surface.
+ * @param x x offset of source surface.
+ * @param y y offset of source surface.
+ * @param mask part of destination surface that can be changed.
+ */
+void ScriptWorkerBlit::executeBlitScript(SurfaceRaw<Uint8> src, SurfaceRaw<Uint8> dest, int x, int y, GraphSubset mask)
+{
+	ShaderMove<Uint8> srcShader(src, x, y);
+	ShaderMove<Uint8> destShader(dest, 0, 0);
+
+	destShader.setDomain(mask);
+
+	auto runScripts = [&](ScriptWorkerBlit::Output& arg)
+	{
+		set(arg);
+		if (_events)
 		{
-			if (_events)
+			auto ptr = _events;
+			while (*ptr)
 			{
-				ShaderDrawFunc(
-					[&](Uint8& destStuff, const Uint8& srcStuff)
-					{
-						if (srcStuff)
-						{
-							ScriptWorkerBlit::Output arg = { srcStuff, destStuff };
-							set(arg);
-							auto ptr = _events;
-							while (*ptr)
-							{
-								reset(arg);
-								scriptExe(*this, ptr->data());
-								++ptr;
-							}
-							++ptr;
+				reset(arg);
+				scriptExe(*this, ptr->data());
+				++ptr;
+			}
+			++ptr;
 
-							reset(arg);
-							scriptExe(*this, _proc);
+			reset(arg);
+			scriptExe(*this, _proc);
 
-							while (*ptr)
-							{
-								reset(arg);
-								scriptExe(*this, ptr->data());
-								++ptr;
-							}
-							++ptr;
+			while (*ptr)
+			{
+				reset(arg);
+				scriptExe(*this, ptr->data());
+				++ptr;
+			}
+			++ptr;
+		}
+		else
+		{
+			scriptExe(*this, _proc);
+		}
+		get(arg);
+	};
 
-							get(arg);
-							if (arg.getFirst()) destStuff = arg.getFirst();
-						}
-					},
-					destShader,
-						srcShader
-						);
+	if (_pixelLookup)
+	{
+		std::bitset<256> used;
+		ShaderDrawFunc(
+			[&](Uint8&, const Uint8& srcStuff)
+			{
+				used.set(srcStuff);
+			},
+			destShader,
+			srcShader
+		);
+
+		Uint8 lookup[256] = { };
+		for (int i = 1; i < 256; ++i)
+		{
+			if (used.test(i))
+			{
+				ScriptWorkerBlit::Output arg = { i, 0 };
+				runScripts(arg);
+				lookup[i] = arg.getFirst();
 			}
-			else
+		}
+
+		ShaderDrawFunc(
+			[&](Uint8& destStuff, const Uint8& srcStuff)
 			{
-				ShaderDrawFunc(
-					[&](Uint8& destStuff, const Uint8& srcStuff)
-					{
-						if (srcStuff)
-						{
-							ScriptWorkerBlit::Output arg = { srcStuff, destStuff };
-							set(arg);
-							scriptExe(*this, _proc);
-							get(arg);
-							if (arg.getFirst()) destStuff = arg.getFirst();
-						}
-					},
-					destShader,
-						srcShader
-						);
+				const Uint8 v = lookup[srcStuff];
+				if (v) destStuff = v;
+			},
+			destShader,
+			srcShader
+		);
+	}
+	else
+	{
+		ShaderDrawFunc(
+			[&](Uint8& destStuff, const Uint8& srcStuff)
+			{
+				if (srcStuff)
+				{
+					ScriptWorkerBlit::Output arg = { srcStuff, destStuff };
+					runScripts(arg);
+					if (arg.getFirst()) destStuff = arg.getFirst();
+				}
+			},
+			destShader,
+			srcShader
+		);
+	}
+}
+
+namespace
+{
+
+/**
+ * Sprite recolored by blit script, zero mean pixel that do not change destination.
+ */
+struct RecolorCacheEntry
+{
+	size_t hash;
+	const Surface* src;
+	const Uint8* proc;
+	const ScriptContainerBase* events;
+	int width, height;
+	std::array<Uint8, ScriptMaxReg> reg;
+	std::vector<Uint8> pixels;
+
+	/// Memory used by this entry.
+	size_t memory() const
+	{
+		return sizeof(RecolorCacheEntry) + pixels.size();
+	}
+};
+
+/**
+ * Recolored sprites ordered from last used.
+ */
+struct RecolorCache
+{
+	using List = std::list<RecolorCacheEntry>;
+
+	List lru;
+	std::unordered_multimap<size_t, List::iterator> index;
+	size_t memory = 0;
+	size_t hits = 0;
+	size_t misses = 0;
+	size_t bypass = 0;
+	size_t evictions = 0;
+
+	/// Remove last used entries until memory fit in budget.
+	void trim(size_t budget)
+	{
+		while (memory > budget && !lru.empty())
+		{
+			auto& last = lru.back();
+			auto range = index.equal_range(last.hash);
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				if (&*it->second == &last)
+				{
+					index.erase(it);
+					break;
+				}
 			}
+			memory -= last.memory();
+			lru.pop_back();
+			++evictions;
 		}
-		else
+	}
+};
+
+RecolorCache recolorCache;
+
+/**
+ * FNV-1a hash of memory block.
+ */
+size_t recolorHash(size_t hash, const void* data, size_t size)
+{
+	auto bytes = static_cast<const Uint8*>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash = (hash ^ bytes[i]) * (size_t)1099511628211ULL;
+	}
+	return hash;
+}
+
+} // namespace
+
+void ScriptWorkerBlit::executeBlitCached(Surface* src, Surface* dest, int x, int y, int shade)
+{
+	executeBlitCached(src, dest, x, y, shade, GraphSubset{ dest->getWidth(), dest->getHeight() });
+}
+
+/**
+ * Blitting one surface to another using script, reusing sprite recolored by previous call with same script and arguments.
+ * Only scripts that compute color from source pixel and param values can reuse sprites,
+ * registers hold pointers of object params, not state of objects, so scripts that read
+ * any object or destination pixel are always run directly.
+ * @param src source surface, need be frame from sprite set that do not change.
+ * @param dest destination surface.
+ * @param x x offset of source surface.
+ * @param y y offset of source surface.
+ * @param mask part of destination surface that can be changed.
+ */
+void ScriptWorkerBlit::executeBlitCached(Surface* src, Surface* dest, int x, int y, int shade, GraphSubset mask)
+{
+	const size_t budget = (size_t)std::max(Options::oxceRecolorCache, 0) * 1024 * 1024;
+	if (!_proc || budget == 0)
+	{
+		executeBlit(src, dest, x, y, shade, mask);
+		return;
+	}
+	if (!_cacheable)
+	{
+		++recolorCache.bypass;
+		executeBlit(src, dest, x, y, shade, mask);
+		return;
+	}
+
+	const Uint8* reg = regData();
+	const int width = src->getWidth();
+	const int height = src->getHeight();
+	size_t hash = (size_t)14695981039346656037ULL;
+	hash = recolorHash(hash, &src, sizeof(src));
+	hash = recolorHash(hash, &_proc, sizeof(_proc));
+	hash = recolorHash(hash, &_events, sizeof(_events));
+	hash = recolorHash(hash, reg, ScriptMaxReg);
+
+	RecolorCacheEntry* entry = nullptr;
+	auto range = recolorCache.index.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		auto& e = *it->second;
+		if (e.src == src && e.proc == _proc && e.events == _events && e.width == width && e.height == height && std::memcmp(e.reg.data(), reg, ScriptMaxReg) == 0)
 		{
-			ShaderDraw<helper::StandardShade>(destShader, srcShader, ShaderScalar(shade));
+			recolorCache.lru.splice(recolorCache.lru.begin(), recolorCache.lru, it->second);
+			entry = &e;
+			break;
 		}
+	}
+
+	if (entry)
+	{
+		++recolorCache.hits;
+	}
+	else
+	{
+		++recolorCache.misses;
+		recolorCache.lru.emplace_front();
+		entry = &recolorCache.lru.front();
+		entry->hash = hash;
+		entry->src = src;
+		entry->proc = _proc;
+		entry->events = _events;
+		entry->width = width;
+		entry->height = height;
+		std::memcpy(entry->reg.data(), reg, ScriptMaxReg);
+		entry->pixels.resize(width * height);
+		recolorCache.index.emplace(hash, recolorCache.lru.begin());
+		recolorCache.memory += entry->memory();
+		executeBlitScript(src, SurfaceRaw<Uint8>(entry->pixels, width, height), 0, 0, GraphSubset{ width, height });
+	}
+
+	ShaderMove<Uint8> cacheShader(SurfaceRaw<Uint8>(entry->pixels, width, height), x, y);
+	ShaderMove<Uint8> destShader(dest, 0, 0);
+
+	destShader.setDomain(mask);
+
+	ShaderDrawFunc(
+		[](Uint8& destStuff, const Uint8& cacheStuff)
+		{
+			if (cacheStuff) destStuff = cacheStuff;
+		},
+		destShader,
+		cacheShader
+	);
+
+	recolorCache.trim(budget);
+}
+
+/**
+ * Drop all recolored sprites and log how useful the cache was.
+ */
+void ScriptWorkerBlit::clearCache()
+{
+	if (recolorCache.hits + recolorCache.misses + recolorCache.bypass > 0)
+	{
+		const size_t total = recolorCache.hits + recolorCache.misses;
+		Log(LOG_INFO) << "Recolor cache: " << recolorCache.hits << " hits, " << recolorCache.misses << " misses, "
+			<< recolorCache.bypass << " bypassed, " << recolorCache.evictions << " evicted"
+			<< ", hit rate " << (total ? recolorCache.hits * 100 / total : 0) << "%"
+			<< ", " << recolorCache.lru.size() << " entries using " << recolorCache.memory / 1024 << " KB";
+	}
+	recolorCache = RecolorCache{};
 }
 
 /**
@@ -704,21 +1218,14 @@ int overloadCustomProc(const ScriptProcData& spd, const ScriptRefData* begin, co
 	return tempSorce;
 }
 /**
- * Helper choosing correct overload function to call.
+ * Helper finding overload that best match arguments.
+ * @param bestValue set to best overload or null if none or more than one match.
+ * @return Score of best overload, zero if nothing match.
  */
-bool callOverloadProc(ParserWriter& ph, const ScriptRange<ScriptProcData>& proc, const ScriptRefData* begin, const ScriptRefData* end)
+int matchOverloadProc(const ScriptRange<ScriptProcData>& proc, const ScriptRefData* begin, const ScriptRefData* end, const ScriptProcData*& bestValue)
 {
-	if (!proc)
-	{
-		return false;
-	}
-	if ((size_t)std::distance(begin, end) > ScriptMaxArg)
-	{
-		return false;
-	}
-
 	int bestSorce = 0;
-	const ScriptProcData* bestValue = nullptr;
+	bestValue = nullptr;
 	for (auto& p : proc)
 	{
 		int tempSorce = p.overload(p, begin, end);
@@ -735,6 +1242,25 @@ bool callOverloadProc(ParserWriter& ph, const ScriptRange<ScriptProcData>& proc,
 			}
 		}
 	}
+	return bestSorce;
+}
+
+/**
+ * Helper choosing correct overload function to call.
+ */
+bool callOverloadProc(ParserWriter& ph, const ScriptRange<ScriptProcData>& proc, const ScriptRefData* begin, const ScriptRefData* end)
+{
+	if (!proc)
+	{
+		return false;
+	}
+	if ((size_t)std::distance(begin, end) > ScriptMaxArg)
+	{
+		return false;
+	}
+
+	const ScriptProcData* bestValue = nullptr;
+	int bestSorce = matchOverloadProc(proc, begin, end, bestValue);
 	if (bestSorce)
 	{
 		if (bestValue)
@@ -989,6 +1515,48 @@ bool parseVariableImpl(ParserWriter& ph, ScriptRefData reg, ScriptRefData val =
 	}
 }
 
+/**
+ * Try fusing `add A C` with directly preceding `set A B` into one `set_add A B C` operation.
+ * @param fused set if operation was fused.
+ * @return False on error.
+ */
+bool parseFusedSetAdd(ParserWriter& ph, const ScriptRefData* begin, const ScriptRefData* end, bool& fused)
+{
+	fused = false;
+	if (std::distance(begin, end) != 2 || ph.lastSetBegin == ProgPos::Unknown || ph.lastSetEnd != ph.getCurrPos() || ph.lastLabelPos == ph.getCurrPos())
+	{
+		return true;
+	}
+
+	const auto& reg = ph.lastSetArgs[0];
+	if (!reg.isValueType<RegEnum>() || !begin[0].isValueType<RegEnum>() || reg.getValue<RegEnum>() != begin[0].getValue<RegEnum>())
+	{
+		return true;
+	}
+	if (begin[1].isValueType<RegEnum>() && begin[1].getValue<RegEnum>() == reg.getValue<RegEnum>())
+	{
+		// `set A B; add A A;` need old value of `A`
+		return true;
+	}
+
+	ScriptRefData fusedArgs[] =
+	{
+		begin[0],
+		ph.lastSetArgs[1],
+		begin[1],
+	};
+	const auto proc = ph.parser.getProc(ScriptRef{ "set_add" });
+	const ScriptProcData* bestValue = nullptr;
+	if (!matchOverloadProc(proc, std::begin(fusedArgs), std::end(fusedArgs), bestValue) || !bestValue)
+	{
+		return true;
+	}
+
+	fused = true;
+	ph.rewind(ph.lastSetBegin);
+	return callOverloadProc(ph, proc, std::begin(fusedArgs), std::end(fusedArgs));
+}
+
 /**
  * Parser of `if` operation.
  */
@@ -1490,6 +2058,8 @@ bool parseDebugLog(const ScriptProcData& spd, ParserWriter& ph, const ScriptRefD
 		}
 	}
 
+	ph.setSideEffects();
+
 	const auto proc = ph.parser.getProc(ScriptRef{ "debug_flush" });
 	return proc.size() == 1 && (*proc.begin())(ph, nullptr, nullptr);
 }
@@ -2146,9 +2716,28 @@ ScriptRefData ParserWriter::getReferece(const ScriptRef& s) const
 	{
 		return ScriptRefData{ };
 	}
+	for (Uint8 i = 0; i < parser.getParamSize(); ++i)
+	{
+		if (ptr == parser.getParamData(i))
+		{
+			container._paramUsed |= (1 << i);
+			if (ArgIsPtr(ptr->type))
+			{
+				container._objectParamUsed = true;
+			}
+		}
+	}
 	return *ptr;
 }
 
+/**
+ * Mark that script do something more than computing output params, like writing log.
+ */
+void ParserWriter::setSideEffects()
+{
+	container._sideEffects = true;
+}
+
 /**
  * Get current position in proc vector.
  * @return Position in proc vector.
@@ -2170,6 +2759,16 @@ size_t ParserWriter::getDiffPos(ProgPos begin, ProgPos end) const
 	return static_cast<size_t>(end) - static_cast<size_t>(begin);
 }
 
+/**
+ * Remove all operations from proc vector after given position.
+ * Only allowed for operations that do not reserve any positions, like labels or texts.
+ * @param pos new end of proc vector.
+ */
+void ParserWriter::rewind(ProgPos pos)
+{
+	container._proc.resize(static_cast<size_t>(pos));
+}
+
 /**
  * Push zeros to fill empty space.
  * @param s Size of empty space.
@@ -2282,6 +2881,7 @@ bool ParserWriter::setLabel(const ScriptRefData& data, ProgPos offset)
 		return false;
 	}
 	refLabels.setValue(temp.value, offset);
+	lastLabelPos = offset;
 	return true;
 }
 
@@ -2815,6 +3415,7 @@ bool ScriptParserBase::parseBase(ScriptContainerBase& destScript, const std::str
 			}
 			help.relese();
 			destScript = std::move(tempScript);
+			ScriptProfiler::add(_shared, destScript, _name, parentName);
 			return true;
 		}
 
@@ -2960,12 +3561,33 @@ bool ScriptParserBase::parseBase(ScriptContainerBase& destScript, const std::str
 			return false;
 		}
 
+		const auto opBegin = help.getCurrPos();
+		bool fused = false;
+		if (op == ScriptRef{ "add" } && parseFusedSetAdd(help, argData, argData+i, fused) == false)
+		{
+			Log(LOG_ERROR) << err << "invalid operation in line: '" << line.toString() << "'";
+			return false;
+		}
+
 		// create normal proc call
-		if (callOverloadProc(help, op_curr, argData, argData+i) == false)
+		if (!fused && callOverloadProc(help, op_curr, argData, argData+i) == false)
 		{
 			Log(LOG_ERROR) << err << "invalid operation in line: '" << line.toString() << "'";
 			return false;
 		}
+
+		// remember `set` that could be fused with next line
+		if (!fused && op == ScriptRef{ "set" } && i == 2)
+		{
+			help.lastSetBegin = opBegin;
+			help.lastSetEnd = help.getCurrPos();
+			help.lastSetArgs[0] = argData[0];
+			help.lastSetArgs[1] = argData[1];
+		}
+		else
+		{
+			help.lastSetBegin = ProgPos::Unknown;
+		}
 	}
 }
 
@@ -3333,7 +3955,7 @@ ScriptGlobal::ScriptGlobal()
  */
 ScriptGlobal::~ScriptGlobal()
 {
-
+	ScriptProfiler::remove(this);
 }
 
 /**
@@ -3582,4 +4204,157 @@ void ScriptGlobal::load(const YAML::Node& node)
 	}
 }
 
+////////////////////////////////////////////////////////////
+//					Script benchmark
+////////////////////////////////////////////////////////////
+
+/**
+ * Run scripts similar to default sprite scripts and documentation examples, check their results and log speed of interpreter.
+ * @return True if all scripts give same results as equivalent C++ code.
+ */
+bool benchmarkScripts()
+{
+	using BenchmarkParser = ScriptParser<ScriptWorkerBlit::Output, int, int, int>;
+
+	struct BenchmarkScript
+	{
+		const char* name;
+		const char* code;
+		int (*expected)(int pixel, int old, int part, int frame, int shade);
+	};
+
+	const BenchmarkScript scripts[] =
+	{
+		{
+			"recolorItemSprite",
+			"add_shade new_pixel shade; return new_pixel;",
+			[](int pixel, int old, int part, int frame, int shade)
+			{
+				addShade_h(pixel, shade);
+				return pixel;
+			}
+		},
+		{
+			"selectSprite",
+			"add new_pixel old_pixel; return new_pixel;",
+			[](int pixel, int old, int part, int frame, int shade)
+			{
+				return pixel + old;
+			}
+		},
+		{
+			"animatedSprite",
+			"var int temp;"
+			"set temp blit_part;"
+			"offsetmod temp 11 0 8;"
+			"add temp anim_frame;"
+			"wavegen_saw temp 8 8 7;"
+			"mul old_pixel 8;"
+			"add old_pixel 8;"
+			"add old_pixel temp;"
+			"set new_pixel old_pixel;"
+			"add new_pixel shade;"
+			"return new_pixel;",
+			[](int pixel, int old, int part, int frame, int shade)
+			{
+				int temp = part;
+				mulAddMod_h(temp, 11, 0, 8);
+				temp += frame;
+				wavegen_saw_h(temp, 8, 8, 7);
+				return old * 8 + 8 + temp + shade;
+			}
+		},
+		{
+			"conditionalRecolor",
+			"var int temp;"
+			"get_color temp new_pixel;"
+			"if eq temp 4;"
+			"  set_color new_pixel blit_part;"
+			"else gt temp 8;"
+			"  add_shade new_pixel shade;"
+			"else;"
+			"  set temp new_pixel;"
+			"  add temp anim_frame;"
+			"  limit temp 1 255;"
+			"  set new_pixel temp;"
+			"end;"
+			"return new_pixel;",
+			[](int pixel, int old, int part, int frame, int shade)
+			{
+				const int color = pixel >> 4;
+				if (color == 4)
+				{
+					return (pixel & 0xF) | (part << 4);
+				}
+				else if (color > 8)
+				{
+					addShade_h(pixel, shade);
+					return pixel;
+				}
+				return std::max(std::min(pixel + frame, 255), 1);
+			}
+		},
+	};
+
+#ifdef OXCE_SCRIPT_THREADED_DISPATCH
+	const char* dispatch = "threaded";
+#else
+	const char* dispatch = "switch";
+#endif
+
+	ScriptGlobal global;
+	BenchmarkParser parser{ &global, "benchmarkScript", "new_pixel", "old_pixel", "blit_part", "anim_frame", "shade" };
+
+	bool valid = true;
+	for (const auto& s : scripts)
+	{
+		BenchmarkParser::Container script;
+		script.load(s.name, s.code, parser);
+		if (!script)
+		{
+			Log(LOG_ERROR) << "Benchmark script '" << s.name << "' failed to parse.";
+			valid = false;
+			continue;
+		}
+
+		const int repeats = 4;
+		size_t runs = 0;
+		int checksum = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (int r = 0; r < repeats; ++r)
+		{
+			for (int part = 0; part < 8; ++part)
+			{
+				for (int frame = 0; frame < 8; ++frame)
+				{
+					for (int shade = 0; shade < 16; ++shade)
+					{
+						BenchmarkParser::Worker worker{ part, frame, shade };
+						for (int pixel = 0; pixel < 256; ++pixel)
+						{
+							const int old = 255 - pixel;
+							BenchmarkParser::Output arg = { pixel, old };
+							worker.execute(script, arg);
+							checksum += arg.getFirst();
+							++runs;
+							if (r == 0 && arg.getFirst() != s.expected(pixel, old, part, frame, shade))
+							{
+								valid = false;
+							}
+						}
+					}
+				}
+			}
+		}
+		const auto time = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		if (!valid)
+		{
+			Log(LOG_ERROR) << "Benchmark script '" << s.name << "' give wrong result.";
+			break;
+		}
+		Log(LOG_INFO) << "Script '" << s.name << "' with " << dispatch << " dispatch: " << time / runs << " ns per run (checksum " << checksum << ")";
+	}
+	return valid;
+}
+
 } //namespace OpenXcom
@@ -50,6 +50,7 @@ class SelectedToken;
 class ScriptWorkerBase;
 class ScriptWorkerBlit;
 template<typename, typename...> class ScriptWorker;
+template<typename> class SurfaceRaw;
 template<typename, typename> struct ScriptTag;
 template<typename, typename> class ScriptValues;
 
@@ -374,6 +375,9 @@ class ScriptContainerBase
 {
 	friend struct ParserWriter;
 	std::vector<Uint8> _proc;
+	Uint16 _paramUsed = 0;
+	bool _objectParamUsed = false;
+	bool _sideEffects = false;
 
 public:
 	/// Constructor.
@@ -384,12 +388,12 @@ public:
 	ScriptContainerBase(ScriptContainerBase&&) = default;
 
 	/// Destructor.
-	~ScriptContainerBase() = default;
+	~ScriptContainerBase();
 
 	/// Copy.
 	ScriptContainerBase &operator=(const ScriptContainerBase&) = delete;
 	/// Move.
-	ScriptContainerBase &operator=(ScriptContainerBase&&) = default;
+	ScriptContainerBase &operator=(ScriptContainerBase&&);
 
 	/// Test if is any script there.
 	explicit operator bool() const
@@ -402,6 +406,22 @@ public:
 	{
 		return *this ? _proc.data() : nullptr;
 	}
+
+	/// Test if script reference given output param.
+	bool isParamUsed(Uint8 i) const
+	{
+		return (_paramUsed >> i) & 1;
+	}
+	/// Test if script reference any object param, its result then depend on state of that object not only on param values.
+	bool isObjectParamUsed() const
+	{
+		return _objectParamUsed;
+	}
+	/// Test if script do something more than computing output params.
+	bool haveSideEffects() const
+	{
+		return _sideEffects;
+	}
 };
 
 /**
@@ -449,6 +469,44 @@ public:
 	{
 		return _events;
 	}
+	/// Test if script reference given output param.
+	bool isParamUsed(Uint8 i) const
+	{
+		return _current.isParamUsed(i);
+	}
+	/// Test if script reference any object param.
+	bool isObjectParamUsed() const
+	{
+		return _current.isObjectParamUsed();
+	}
+	/// Test if script do something more than computing output params.
+	bool haveSideEffects() const
+	{
+		return _current.haveSideEffects();
+	}
+	/// Test if script or any of global events do something more than computing output params.
+	bool haveAnySideEffects() const
+	{
+		if (_current.haveSideEffects())
+		{
+			return true;
+		}
+		if (auto* ptr = _events)
+		{
+			// two null terminated lists, before and after main script.
+			for (int i = 0; i < 2; ++i, ++ptr)
+			{
+				for (; *ptr; ++ptr)
+				{
+					if (ptr->haveSideEffects())
+					{
+						return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
 };
 
 /**
@@ -701,6 +759,12 @@ protected:
 	/// Call script.
 	void executeBase(const Uint8* proc);
 
+	/// Get raw memory of all regs.
+	const Uint8* regData() const
+	{
+		return reinterpret_cast<const Uint8*>(&reg);
+	}
+
 public:
 	/// Default constructor.
 	ScriptWorkerBase()
@@ -803,6 +867,36 @@ class ScriptWorkerBlit : public ScriptWorkerBase
 	/// Current script set in worker.
 	const Uint8* _proc;
 	const ScriptContainerBase* _events;
+	/// Some of scripts read current pixel of destination.
+	bool _readDest;
+	/// Result of scripts depend only on source pixel and can be precomputed for each color.
+	bool _pixelLookup;
+	/// Result of scripts depend only on source pixel and param values, recolored sprite can be reused.
+	bool _cacheable;
+
+	/// Test if any script in events list fulfill predicate.
+	template<typename F>
+	static bool anyEvents(const ScriptContainerBase* ptr, F&& f)
+	{
+		if (ptr)
+		{
+			// two null terminated lists, before and after main script.
+			for (int i = 0; i < 2; ++i, ++ptr)
+			{
+				for (; *ptr; ++ptr)
+				{
+					if (f(*ptr))
+					{
+						return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	/// Run blit scripts for each pixel of source.
+	void executeBlitScript(SurfaceRaw<Uint8> src, SurfaceRaw<Uint8> dest, int x, int y, GraphSubset mask);
 
 public:
 	/// Type of output value from script.
@@ -810,7 +904,7 @@ public:
 	using Output32 = ScriptOutputArgs<Uint32&, Uint32>;
 
 	/// Default constructor.
-	ScriptWorkerBlit() : ScriptWorkerBase(), _proc(nullptr), _events(nullptr)
+	ScriptWorkerBlit() : ScriptWorkerBase(), _proc(nullptr), _events(nullptr), _readDest(false), _pixelLookup(false), _cacheable(false)
 	{
 
 	}
@@ -825,6 +919,9 @@ public:
 		{
 			_proc = c.data();
 			_events = nullptr;
+			_readDest = c.isParamUsed(1);
+			_pixelLookup = !_readDest && !c.haveSideEffects();
+			_cacheable = _pixelLookup && !c.isObjectParamUsed();
 			updateBase<Output>(args...);
 		}
 	}
@@ -839,6 +936,9 @@ public:
 		{
 			_proc = c.data();
 			_events = c.dataEvents();
+			_readDest = c.isParamUsed(1) || anyEvents(_events, [](const ScriptContainerBase& e) { return e.isParamUsed(1); });
+			_pixelLookup = !_readDest && !c.haveSideEffects() && !anyEvents(_events, [](const ScriptContainerBase& e) { return e.haveSideEffects(); });
+			_cacheable = _pixelLookup && !c.isObjectParamUsed() && !anyEvents(_events, [](const ScriptContainerBase& e) { return e.isObjectParamUsed(); });
 			updateBase<Output>(args...);
 		}
 	}
@@ -847,12 +947,21 @@ public:
 	void executeBlit(Surface* src, Surface* dest, int x, int y, int shade);
 	/// Programmable blitting using script.
 	void executeBlit(Surface* src, Surface* dest, int x, int y, int shade, GraphSubset mask);
+	/// Programmable blitting using script, reusing recolored sprite from previous calls.
+	void executeBlitCached(Surface* src, Surface* dest, int x, int y, int shade);
+	/// Programmable blitting using script, reusing recolored sprite from previous calls.
+	void executeBlitCached(Surface* src, Surface* dest, int x, int y, int shade, GraphSubset mask);
+	/// Drop all recolored sprites and log cache statistics.
+	static void clearCache();
 
 	/// Clear all worker data.
 	void clear()
 	{
 		_proc = nullptr;
 		_events = nullptr;
+		_readDest = false;
+		_pixelLookup = false;
+		_cacheable = false;
 	}
 };
 
@@ -1615,6 +1724,7 @@ private:
 	std::map<ArgEnum, TagData> _tagNames;
 	std::vector<TagValueType> _tagValueTypes;
 	std::vector<ScriptRefData> _refList;
+	std::string _modName;
 
 	/// Get tag value.
 	size_t getTag(ArgEnum type, ScriptRef s) const;
@@ -1648,6 +1758,11 @@ public:
 	/// Get global ref data.
 	const ScriptRefData* getRef(ScriptRef name, ScriptRef postfix = {}) const;
 
+	/// Set name of mod that scripts are currently loaded from.
+	void setModName(const std::string& name) { _modName = name; }
+	/// Get name of mod that scripts are currently loaded from.
+	const std::string& getModName() const { return _modName; }
+
 	/// Get all tag names
 	const std::map<ArgEnum, TagData> &getTagNames() const { return _tagNames; }
 
@@ -1846,6 +1961,25 @@ public:
 	}
 };
 
+/// Check and log speed of script interpreter for typical scripts.
+bool benchmarkScripts();
+
+/**
+ * Statistics of script execution, collected only when option `oxceScriptProfiler` is set.
+ */
+class ScriptProfiler
+{
+public:
+	/// Register script code, results will be attributed to its hook, rule and mod.
+	static void add(const ScriptGlobal* shared, const ScriptContainerBase& script, const std::string& hook, const std::string& rule);
+	/// Forget all scripts registered by given global data.
+	static void remove(const ScriptGlobal* shared);
+	/// Forget script code that is going to be freed.
+	static void remove(const ScriptContainerBase& script);
+	/// Log collected statistics, optionally save them as CSV, and reset them.
+	static void report(const std::string& csvFile);
+};
+
 #define MACRO_GET_STRING_1(str, i) \
 	(sizeof(str) > (i) ? str[(i)] : 0)
 
@@ -158,6 +158,15 @@ struct ParserWriter
 
 	/// Stack of registers limited to code blocks.
 	std::vector<ScriptRefData> regStack;
+
+	/// Position of last label.
+	ProgPos lastLabelPos = ProgPos::Unknown;
+	/// Position of last `set` operation that can be fused with next operation.
+	ProgPos lastSetBegin = ProgPos::Unknown;
+	/// Position after last `set` operation.
+	ProgPos lastSetEnd = ProgPos::Unknown;
+	/// Arguments of last `set` operation.
+	ScriptRefData lastSetArgs[2] = { };
 	/// Store position of blocks of code like "if" or "while".
 	std::vector<Block> codeBlocks;
 
@@ -174,6 +183,8 @@ struct ParserWriter
 
 	/// Get reference based on name.
 	ScriptRefData getReferece(const ScriptRef& s) const;
+	/// Mark that script do something more than computing output params.
+	void setSideEffects();
 
 	/// Get current position in proc vector.
 	ProgPos getCurrPos() const;
@@ -181,6 +192,8 @@ struct ParserWriter
 	size_t getDiffPos(ProgPos begin, ProgPos end) const;
 
 
+	/// Remove operations from proc vector.
+	void rewind(ProgPos pos);
 	/// Push zeros to fill empty space.
 	ProgPos push(size_t s);
 	/// Update space on proc vector.
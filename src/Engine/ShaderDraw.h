@@ -18,6 +18,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "ShaderDrawHelper.h"
+#include "ShaderDrawSimd.h"
 #include "HelperMeta.h"
 #include <tuple>
 
@@ -32,10 +33,11 @@ static inline First&& GetFirst(First&& f, Rest&&... r)
 
 /**
  * Universal blit function implementation.
+ * @tparam Rows if true `f` is called once for each row with its length and pointers to first pixels.
  * @param f called function.
  * @param src source surfaces control objects.
  */
-template<typename Func, typename... SrcType>
+template<bool Rows = false, typename Func, typename... SrcType>
 static inline void ShaderDrawImpl(Func&& f, helper::controler<SrcType>... src)
 {
 	//get basic draw range in 2d space
@@ -78,22 +80,30 @@ static inline void ShaderDrawImpl(Func&& f, helper::controler<SrcType>... src)
 		(src.set_x(begin_x, end_x), ...);
 
 		int size_x = end_x-begin_x;
-		//iteration on x-axis
-		for (int x = size_x / 4; x>0; --x)
-		{
-			f(src.get_ref()...); (src.inc_x(), ...);
-			f(src.get_ref()...); (src.inc_x(), ...);
-			f(src.get_ref()...); (src.inc_x(), ...);
-			f(src.get_ref()...); (src.inc_x(), ...);
-		}
-		if (size_x & 2)
+		if constexpr (Rows)
 		{
-			f(src.get_ref()...); (src.inc_x(), ...);
-			f(src.get_ref()...); (src.inc_x(), ...);
+			//whole row at once
+			f(size_x, src.get_row()...);
 		}
-		if (size_x & 1)
+		else
 		{
-			f(src.get_ref()...); (src.inc_x(), ...);
+			//iteration on x-axis
+			for (int x = size_x / 4; x>0; --x)
+			{
+				f(src.get_ref()...); (src.inc_x(), ...);
+				f(src.get_ref()...); (src.inc_x(), ...);
+				f(src.get_ref()...); (src.inc_x(), ...);
+				f(src.get_ref()...); (src.inc_x(), ...);
+			}
+			if (size_x & 2)
+			{
+				f(src.get_ref()...); (src.inc_x(), ...);
+				f(src.get_ref()...); (src.inc_x(), ...);
+			}
+			if (size_x & 1)
+			{
+				f(src.get_ref()...); (src.inc_x(), ...);
+			}
 		}
 	}
 
@@ -111,6 +121,18 @@ static inline void ShaderDraw(const SrcType&... src_frame)
 	ShaderDrawImpl([](auto&&... a){ ColorFunc::func(std::forward<decltype(a)>(a)...); }, helper::controler<SrcType>(src_frame)...);
 }
 
+/**
+ * Universal blit function that process whole rows at once.
+ * @tparam ColorFunc class that contains static function `funcRow`.
+ * function get length of row and pointers to first pixels in that row.
+ * @param src_frame destination and source surfaces modified by function.
+ */
+template<typename ColorFunc, typename... SrcType>
+static inline void ShaderDrawRow(const SrcType&... src_frame)
+{
+	ShaderDrawImpl<true>([](int size, auto&&... a){ ColorFunc::funcRow(size, std::forward<decltype(a)>(a)...); }, helper::controler<SrcType>(src_frame)...);
+}
+
 /**
  * Universal blit function.
  * @param f function that modify other arguments.
@@ -169,6 +191,19 @@ struct ColorReplace
 #endif
 	}
 
+	/**
+	* Function used by ShaderDrawRow in Surface::blitNShade
+	* same as `func` but for whole row of pixels, use SIMD if available.
+	* @param size length of row
+	* @param dest first destination pixel
+	* @param src first source pixel
+	* @param shade value of shade of this surface
+	* @param newColor new color to set (it should be offset by 4)
+	*/
+	static inline void funcRow(int size, Uint8* dest, const Uint8* src, const int& shade, const int& newColor)
+	{
+		getShaderRowKernels().colorReplace(dest, src, size, shade, newColor);
+	}
 };
 
 struct ColorReplace32
@@ -234,6 +269,18 @@ struct StandardShade
 #endif
 	}
 
+	/**
+	* Function used by ShaderDrawRow in Surface::blitNShade
+	* same as `func` but for whole row of pixels, use SIMD if available.
+	* @param size length of row
+	* @param dest first destination pixel
+	* @param src first source pixel
+	* @param shade value of shade of this surface
+	*/
+	static inline void funcRow(int size, Uint8* dest, const Uint8* src, const int& shade)
+	{
+		getShaderRowKernels().standardShade(dest, src, size, shade);
+	}
 };
 
 struct StandardShade32
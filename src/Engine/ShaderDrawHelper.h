@@ -185,6 +185,7 @@ struct controler
 	inline void inc_x() = delete;
 
 	inline int& get_ref() = delete;
+	inline int* get_row() = delete;
 };
 
 /// implementation for scalars types aka `int`, `double`, `float`
@@ -241,6 +242,11 @@ struct controler<Scalar<T> >
 	{
 		return ref;
 	}
+
+	inline T& get_row()
+	{
+		return ref;
+	}
 };
 
 template<typename PixelPtr, typename PixelRef>
@@ -316,6 +322,11 @@ struct controler_base
 	{
 		return *ptr_pos_x;
 	}
+
+	inline PixelPtr get_row()
+	{
+		return ptr_pos_x;
+	}
 };
 
 
@@ -0,0 +1,486 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ShaderDrawSimd.h"
+#include "Logger.h"
+#include <chrono>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define OXCE_SIMD_X86
+#define OXCE_TARGET_SSE2 __attribute__((target("sse2")))
+#define OXCE_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#define OXCE_SIMD_X86
+#define OXCE_TARGET_SSE2
+#define OXCE_TARGET_AVX2
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace OpenXcom
+{
+
+namespace helper
+{
+
+namespace
+{
+
+const Uint8 RowColorGroup = 0xF0;
+const Uint8 RowColorShade = 0x0F;
+
+////////////////////////////////////////////////////////////
+//						Scalar
+////////////////////////////////////////////////////////////
+
+/**
+ * Scalar version of `StandardShade`, used for tail of rows too.
+ */
+void standardShadeScalar(Uint8* dest, const Uint8* src, int size, int shade)
+{
+	for (int i = 0; i < size; ++i)
+	{
+		const Uint8 s = src[i];
+		if (s)
+		{
+			const Uint8 newShade = s + shade;
+			if ((newShade ^ s) & RowColorGroup)
+				dest[i] = RowColorShade;
+			else
+				dest[i] = newShade;
+		}
+	}
+}
+
+/**
+ * Scalar version of `ColorReplace`, used for tail of rows too.
+ */
+void colorReplaceScalar(Uint8* dest, const Uint8* src, int size, int shade, int newColor)
+{
+	for (int i = 0; i < size; ++i)
+	{
+		const Uint8 s = src[i];
+		if (s)
+		{
+			const Uint8 newShade = (s & RowColorShade) + shade;
+			if (newShade & RowColorGroup)
+				dest[i] = RowColorShade;
+			else
+				dest[i] = newColor | newShade;
+		}
+	}
+}
+
+/**
+ * Scalar version of globe `CreateShadow`, used for tail of rows too.
+ */
+void globeShadowScalar(Uint8* dest, const Uint8* shadow, int size, int oceanColor, bool oceanShading)
+{
+	for (int i = 0; i < size; ++i)
+	{
+		const Uint8 d = dest[i];
+		const Uint8 s = shadow[i];
+		if (d && s != GlobeShadowOutside)
+		{
+			if (oceanShading && d >= oceanColor && d < oceanColor + 32)
+			{
+				dest[i] = oceanColor + s;
+			}
+			else if (s)
+			{
+				const int e = d + s / 3;
+				const int max = (d & RowColorGroup) + RowColorShade;
+				dest[i] = e > max ? max : e;
+			}
+		}
+		else
+		{
+			dest[i] = 0;
+		}
+	}
+}
+
+/**
+ * Check if SIMD version of globe shadow can handle given ocean color,
+ * ocean range can't wrap around in 8bit math.
+ */
+inline bool globeShadowSimdColor(int oceanColor)
+{
+	return oceanColor <= 256 - 32;
+}
+
+const ShaderRowKernels ScalarKernels = { "scalar", &standardShadeScalar, &colorReplaceScalar, &globeShadowScalar };
+
+#ifdef OXCE_SIMD_X86
+
+////////////////////////////////////////////////////////////
+//						SSE2
+////////////////////////////////////////////////////////////
+
+OXCE_TARGET_SSE2
+void standardShadeSSE2(Uint8* dest, const Uint8* src, int size, int shade)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i group = _mm_set1_epi8((char)RowColorGroup);
+	const __m128i black = _mm_set1_epi8((char)RowColorShade);
+	const __m128i add = _mm_set1_epi8((char)shade);
+
+	int i = 0;
+	for (; i + 16 <= size; i += 16)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dest + i));
+		const __m128i n = _mm_add_epi8(s, add);
+		// 0xFF where color group is unchanged
+		const __m128i same = _mm_cmpeq_epi8(_mm_and_si128(_mm_xor_si128(n, s), group), zero);
+		const __m128i shaded = _mm_or_si128(_mm_and_si128(same, n), _mm_andnot_si128(same, black));
+		const __m128i empty = _mm_cmpeq_epi8(s, zero);
+		const __m128i r = _mm_or_si128(_mm_and_si128(empty, d), _mm_andnot_si128(empty, shaded));
+		_mm_storeu_si128((__m128i*)(dest + i), r);
+	}
+	standardShadeScalar(dest + i, src + i, size - i, shade);
+}
+
+OXCE_TARGET_SSE2
+void colorReplaceSSE2(Uint8* dest, const Uint8* src, int size, int shade, int newColor)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i group = _mm_set1_epi8((char)RowColorGroup);
+	const __m128i black = _mm_set1_epi8((char)RowColorShade);
+	const __m128i add = _mm_set1_epi8((char)shade);
+	const __m128i color = _mm_set1_epi8((char)newColor);
+
+	int i = 0;
+	for (; i + 16 <= size; i += 16)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dest + i));
+		const __m128i n = _mm_add_epi8(_mm_and_si128(s, black), add);
+		const __m128i same = _mm_cmpeq_epi8(_mm_and_si128(n, group), zero);
+		const __m128i shaded = _mm_or_si128(_mm_and_si128(same, _mm_or_si128(n, color)), _mm_andnot_si128(same, black));
+		const __m128i empty = _mm_cmpeq_epi8(s, zero);
+		const __m128i r = _mm_or_si128(_mm_and_si128(empty, d), _mm_andnot_si128(empty, shaded));
+		_mm_storeu_si128((__m128i*)(dest + i), r);
+	}
+	colorReplaceScalar(dest + i, src + i, size - i, shade, newColor);
+}
+
+OXCE_TARGET_SSE2
+void globeShadowSSE2(Uint8* dest, const Uint8* shadow, int size, int oceanColor, bool oceanShading)
+{
+	if (!globeShadowSimdColor(oceanColor))
+	{
+		globeShadowScalar(dest, shadow, size, oceanColor, oceanShading);
+		return;
+	}
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i group = _mm_set1_epi8((char)RowColorGroup);
+	const __m128i black = _mm_set1_epi8((char)RowColorShade);
+	const __m128i outside = _mm_set1_epi8((char)GlobeShadowOutside);
+	const __m128i ocean = _mm_set1_epi8((char)oceanColor);
+	const __m128i oceanSize = _mm_set1_epi8(31);
+	const __m128i oceanEnabled = oceanShading ? _mm_cmpeq_epi8(zero, zero) : zero;
+	const __m128i third = _mm_set1_epi16(0x5556);
+
+	int i = 0;
+	for (; i + 16 <= size; i += 16)
+	{
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dest + i));
+		const __m128i s = _mm_loadu_si128((const __m128i*)(shadow + i));
+		// `s / 3` in 16bit math
+		const __m128i lo = _mm_mulhi_epu16(_mm_unpacklo_epi8(s, zero), third);
+		const __m128i hi = _mm_mulhi_epu16(_mm_unpackhi_epi8(s, zero), third);
+		const __m128i land = _mm_min_epu8(_mm_adds_epu8(d, _mm_packus_epi16(lo, hi)), _mm_or_si128(_mm_and_si128(d, group), black));
+		const __m128i rel = _mm_sub_epi8(d, ocean);
+		const __m128i isOcean = _mm_and_si128(_mm_cmpeq_epi8(_mm_min_epu8(rel, oceanSize), rel), oceanEnabled);
+		const __m128i shaded = _mm_or_si128(_mm_and_si128(isOcean, _mm_add_epi8(ocean, s)), _mm_andnot_si128(isOcean, land));
+		const __m128i empty = _mm_or_si128(_mm_cmpeq_epi8(d, zero), _mm_cmpeq_epi8(s, outside));
+		_mm_storeu_si128((__m128i*)(dest + i), _mm_andnot_si128(empty, shaded));
+	}
+	globeShadowScalar(dest + i, shadow + i, size - i, oceanColor, oceanShading);
+}
+
+const ShaderRowKernels SSE2Kernels = { "sse2", &standardShadeSSE2, &colorReplaceSSE2, &globeShadowSSE2 };
+
+////////////////////////////////////////////////////////////
+//						AVX2
+////////////////////////////////////////////////////////////
+
+OXCE_TARGET_AVX2
+void standardShadeAVX2(Uint8* dest, const Uint8* src, int size, int shade)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i group = _mm256_set1_epi8((char)RowColorGroup);
+	const __m256i black = _mm256_set1_epi8((char)RowColorShade);
+	const __m256i add = _mm256_set1_epi8((char)shade);
+
+	int i = 0;
+	for (; i + 32 <= size; i += 32)
+	{
+		const __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+		const __m256i d = _mm256_loadu_si256((const __m256i*)(dest + i));
+		const __m256i n = _mm256_add_epi8(s, add);
+		const __m256i same = _mm256_cmpeq_epi8(_mm256_and_si256(_mm256_xor_si256(n, s), group), zero);
+		const __m256i shaded = _mm256_blendv_epi8(black, n, same);
+		const __m256i empty = _mm256_cmpeq_epi8(s, zero);
+		_mm256_storeu_si256((__m256i*)(dest + i), _mm256_blendv_epi8(shaded, d, empty));
+	}
+	// avoid penalty of mixing AVX and SSE code
+	_mm256_zeroupper();
+	standardShadeSSE2(dest + i, src + i, size - i, shade);
+}
+
+OXCE_TARGET_AVX2
+void colorReplaceAVX2(Uint8* dest, const Uint8* src, int size, int shade, int newColor)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i group = _mm256_set1_epi8((char)RowColorGroup);
+	const __m256i black = _mm256_set1_epi8((char)RowColorShade);
+	const __m256i add = _mm256_set1_epi8((char)shade);
+	const __m256i color = _mm256_set1_epi8((char)newColor);
+
+	int i = 0;
+	for (; i + 32 <= size; i += 32)
+	{
+		const __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+		const __m256i d = _mm256_loadu_si256((const __m256i*)(dest + i));
+		const __m256i n = _mm256_add_epi8(_mm256_and_si256(s, black), add);
+		const __m256i same = _mm256_cmpeq_epi8(_mm256_and_si256(n, group), zero);
+		const __m256i shaded = _mm256_blendv_epi8(black, _mm256_or_si256(n, color), same);
+		const __m256i empty = _mm256_cmpeq_epi8(s, zero);
+		_mm256_storeu_si256((__m256i*)(dest + i), _mm256_blendv_epi8(shaded, d, empty));
+	}
+	// avoid penalty of mixing AVX and SSE code
+	_mm256_zeroupper();
+	colorReplaceSSE2(dest + i, src + i, size - i, shade, newColor);
+}
+
+OXCE_TARGET_AVX2
+void globeShadowAVX2(Uint8* dest, const Uint8* shadow, int size, int oceanColor, bool oceanShading)
+{
+	if (!globeShadowSimdColor(oceanColor))
+	{
+		globeShadowScalar(dest, shadow, size, oceanColor, oceanShading);
+		return;
+	}
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i group = _mm256_set1_epi8((char)RowColorGroup);
+	const __m256i black = _mm256_set1_epi8((char)RowColorShade);
+	const __m256i outside = _mm256_set1_epi8((char)GlobeShadowOutside);
+	const __m256i ocean = _mm256_set1_epi8((char)oceanColor);
+	const __m256i oceanSize = _mm256_set1_epi8(31);
+	const __m256i oceanEnabled = oceanShading ? _mm256_cmpeq_epi8(zero, zero) : zero;
+	const __m256i third = _mm256_set1_epi16(0x5556);
+
+	int i = 0;
+	for (; i + 32 <= size; i += 32)
+	{
+		const __m256i d = _mm256_loadu_si256((const __m256i*)(dest + i));
+		const __m256i s = _mm256_loadu_si256((const __m256i*)(shadow + i));
+		// unpack and pack work per 128bit lane, so order of bytes is preserved
+		const __m256i lo = _mm256_mulhi_epu16(_mm256_unpacklo_epi8(s, zero), third);
+		const __m256i hi = _mm256_mulhi_epu16(_mm256_unpackhi_epi8(s, zero), third);
+		const __m256i land = _mm256_min_epu8(_mm256_adds_epu8(d, _mm256_packus_epi16(lo, hi)), _mm256_or_si256(_mm256_and_si256(d, group), black));
+		const __m256i rel = _mm256_sub_epi8(d, ocean);
+		const __m256i isOcean = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(rel, oceanSize), rel), oceanEnabled);
+		const __m256i shaded = _mm256_blendv_epi8(land, _mm256_add_epi8(ocean, s), isOcean);
+		const __m256i empty = _mm256_or_si256(_mm256_cmpeq_epi8(d, zero), _mm256_cmpeq_epi8(s, outside));
+		_mm256_storeu_si256((__m256i*)(dest + i), _mm256_andnot_si256(empty, shaded));
+	}
+	// avoid penalty of mixing AVX and SSE code
+	_mm256_zeroupper();
+	globeShadowSSE2(dest + i, shadow + i, size - i, oceanColor, oceanShading);
+}
+
+const ShaderRowKernels AVX2Kernels = { "avx2", &standardShadeAVX2, &colorReplaceAVX2, &globeShadowAVX2 };
+
+/**
+ * Checks if CPU and OS support SSE2 instructions.
+ */
+bool haveSSE2()
+{
+#ifdef _MSC_VER
+	int CPUInfo[4];
+	__cpuid(CPUInfo, 1);
+	return (CPUInfo[3] & (1 << 26)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+#endif
+}
+
+/**
+ * Checks if CPU and OS support AVX2 instructions.
+ */
+bool haveAVX2()
+{
+#ifdef _MSC_VER
+	int CPUInfo[4];
+	__cpuid(CPUInfo, 1);
+	const bool osxsave = (CPUInfo[2] & (1 << 27)) != 0;
+	const bool avx = (CPUInfo[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+	__cpuidex(CPUInfo, 7, 0);
+	return (CPUInfo[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+/**
+ * Gets all kernels available on current CPU, best last.
+ */
+std::vector<const ShaderRowKernels*> getAvailableKernels()
+{
+	std::vector<const ShaderRowKernels*> list = { &ScalarKernels };
+#ifdef OXCE_SIMD_X86
+	if (haveSSE2())
+	{
+		list.push_back(&SSE2Kernels);
+		if (haveAVX2())
+		{
+			list.push_back(&AVX2Kernels);
+		}
+	}
+#endif
+	return list;
+}
+
+} //namespace
+
+/**
+ * Gets kernels best for current CPU, selected on first call.
+ * @return Set of row functions.
+ */
+const ShaderRowKernels& getShaderRowKernels()
+{
+	static const ShaderRowKernels* best = getAvailableKernels().back();
+	return *best;
+}
+
+/**
+ * Gets kernels that work one pixel at time.
+ * @return Set of row functions.
+ */
+const ShaderRowKernels& getShaderRowKernelsScalar()
+{
+	return ScalarKernels;
+}
+
+/**
+ * Compare all available kernels with scalar version and log their speed.
+ * @return True if every kernel give same result as scalar one.
+ */
+bool benchmarkShaderRowKernels()
+{
+	const int rowSize = 320;
+	const int rows = 200;
+	const int repeats = 200;
+
+	// fixed pseudo random data, game RNG is not touched
+	std::vector<Uint8> src(rowSize * rows);
+	Uint32 seed = 0x12345678;
+	for (auto& p : src)
+	{
+		seed = seed * 1103515245 + 12345;
+		p = (seed >> 16) & 0xFF;
+		if ((seed >> 8) % 4 == 0)
+		{
+			p = 0;
+		}
+	}
+	std::vector<Uint8> background(src.rbegin(), src.rend());
+	std::vector<Uint8> shadow(src.size());
+	for (size_t i = 0; i < shadow.size(); ++i)
+	{
+		shadow[i] = src[i] % 8 == 0 ? GlobeShadowOutside : src[i] % 32;
+	}
+
+	bool valid = true;
+	const auto& scalar = getShaderRowKernelsScalar();
+	std::vector<Uint8> expected, result;
+	for (auto* k : getAvailableKernels())
+	{
+		// check every row length to cover tail handling
+		for (int size = 0; size <= 2 * 32 + 1 && valid; ++size)
+		{
+			for (int shade = -16; shade <= 16 && valid; ++shade)
+			{
+				for (int newColor = 0; newColor < 256 && valid; newColor += 16)
+				{
+					expected.assign(background.begin(), background.begin() + size);
+					result = expected;
+					scalar.colorReplace(expected.data(), src.data() + shade + 16, size, shade, newColor);
+					k->colorReplace(result.data(), src.data() + shade + 16, size, shade, newColor);
+					valid = expected == result;
+				}
+				expected.assign(background.begin(), background.begin() + size);
+				result = expected;
+				scalar.standardShade(expected.data(), src.data() + shade + 16, size, shade);
+				k->standardShade(result.data(), src.data() + shade + 16, size, shade);
+				valid = valid && expected == result;
+			}
+			for (int oceanColor = 0; oceanColor < 256 && valid; oceanColor += 8)
+			{
+				for (int oceanShading = 0; oceanShading < 2 && valid; ++oceanShading)
+				{
+					expected.assign(background.begin(), background.begin() + size);
+					result = expected;
+					scalar.globeShadow(expected.data(), shadow.data() + oceanColor, size, oceanColor, oceanShading);
+					k->globeShadow(result.data(), shadow.data() + oceanColor, size, oceanColor, oceanShading);
+					valid = expected == result;
+				}
+			}
+		}
+		if (!valid)
+		{
+			Log(LOG_ERROR) << "Blit kernels '" << k->name << "' give different result than scalar version.";
+			break;
+		}
+
+		result = background;
+		const auto start = std::chrono::steady_clock::now();
+		for (int r = 0; r < repeats; ++r)
+		{
+			for (int y = 0; y < rows; ++y)
+			{
+				k->standardShade(result.data() + y * rowSize, src.data() + y * rowSize, rowSize, r % 16);
+				k->colorReplace(result.data() + y * rowSize, src.data() + y * rowSize, rowSize, r % 16, (r % 16) << 4);
+				k->globeShadow(result.data() + y * rowSize, shadow.data() + y * rowSize, rowSize, 192, true);
+			}
+		}
+		const auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+		Log(LOG_INFO) << "Blit kernels '" << k->name << "': " << time << "us for " << repeats << " frames of " << rowSize << "x" << rows;
+	}
+	Log(LOG_INFO) << "Blit kernels selected: '" << getShaderRowKernels().name << "'";
+	return valid;
+}
+
+}//namespace helper
+
+}//namespace OpenXcom
@@ -0,0 +1,62 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <SDL_types.h>
+
+namespace OpenXcom
+{
+
+namespace helper
+{
+
+/// Shade one row of pixels, same as `StandardShade::func` for each pixel.
+using StandardShadeRowFunc = void (*)(Uint8* dest, const Uint8* src, int size, int shade);
+/// Shade and recolor one row of pixels, same as `ColorReplace::func` for each pixel.
+using ColorReplaceRowFunc = void (*)(Uint8* dest, const Uint8* src, int size, int shade, int newColor);
+/// Apply precalculated shadow to one row of globe pixels, same as `CreateShadow::func` in `Globe` for each pixel.
+using GlobeShadowRowFunc = void (*)(Uint8* dest, const Uint8* shadow, int size, int oceanColor, bool oceanShading);
+
+/// Value of globe shadow mask for pixels outside of globe.
+const Uint8 GlobeShadowOutside = 0xFF;
+
+/**
+ * Set of functions that process whole rows of 8bit pixels.
+ */
+struct ShaderRowKernels
+{
+	/// Name of instruction set used by kernels.
+	const char* name;
+	/// Implementation of `StandardShade`.
+	StandardShadeRowFunc standardShade;
+	/// Implementation of `ColorReplace`.
+	ColorReplaceRowFunc colorReplace;
+	/// Implementation of globe `CreateShadow`.
+	GlobeShadowRowFunc globeShadow;
+};
+
+/// Gets kernels best for current CPU.
+const ShaderRowKernels& getShaderRowKernels();
+/// Gets kernels that work one pixel at time.
+const ShaderRowKernels& getShaderRowKernelsScalar();
+/// Compare all available kernels with scalar version and log their speed.
+bool benchmarkShaderRowKernels();
+
+}//namespace helper
+
+}//namespace OpenXcom
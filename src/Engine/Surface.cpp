@@ -1299,11 +1299,11 @@ void Surface::blitRaw(SurfaceRaw<Uint8> destSurf, SurfaceRaw<const Uint8> srcSur
 	{
 		--newBaseColor;
 		newBaseColor <<= 4;
-		ShaderDraw<helper::ColorReplace>(ShaderSurface(destSurf), src, ShaderScalar(shade), ShaderScalar(newBaseColor));
+		ShaderDrawRow<helper::ColorReplace>(ShaderSurface(destSurf), src, ShaderScalar(shade), ShaderScalar(newBaseColor));
 	}
 	else
 	{
-		ShaderDraw<helper::StandardShade>(ShaderSurface(destSurf), src, ShaderScalar(shade));
+		ShaderDrawRow<helper::StandardShade>(ShaderSurface(destSurf), src, ShaderScalar(shade));
 	}
 }
 void Surface::blitRaw(SurfaceRaw<Uint32> destSurf, SurfaceRaw<const Uint32> srcSurf, SDL_PixelFormat* format, int x, int y, int shade, bool half, SDL_Color newBaseColor)
@@ -1359,7 +1359,7 @@ void Surface::blitNShade(SurfaceRaw<Uint8> surface, int x, int y, int shade, Gra
 
 	dest.setDomain(range);
 
-	ShaderDraw<helper::StandardShade>(dest, src, ShaderScalar(shade));
+	ShaderDrawRow<helper::StandardShade>(dest, src, ShaderScalar(shade));
 }
 
 /**
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include "ThreadPool.h"
+#include "Options.h"
+#include "Logger.h"
+#include "../fmath.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+/// Set when current thread is already running part of some job.
+thread_local bool insideJob = false;
+
+/**
+ * Gets number of worker threads requested by options.
+ */
+size_t getWorkerThreadsCount()
+{
+	int threads = Options::oxceWorkerThreads;
+	if (threads <= 0)
+	{
+		threads = (int)std::thread::hardware_concurrency() - 1;
+	}
+	return (size_t)Clamp(threads, 0, 64);
+}
+
+}//namespace
+
+/**
+ * Starts worker threads.
+ * @param threads Number of additional threads, zero mean all work is done by caller.
+ */
+ThreadPool::ThreadPool(size_t threads) : _job(nullptr), _jobSize(0), _nextIndex(0), _running(0), _generation(0), _quit(false)
+{
+	for (size_t i = 0; i < threads; ++i)
+	{
+		_threads.push_back(std::thread(&ThreadPool::workerLoop, this));
+	}
+	if (threads > 0)
+	{
+		Log(LOG_INFO) << "Started " << threads << " worker threads.";
+	}
+}
+
+/**
+ * Stops worker threads.
+ */
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_quit = true;
+	}
+	_wakeUp.notify_all();
+	for (auto& t : _threads)
+	{
+		t.join();
+	}
+}
+
+/**
+ * Runs one index of current job, lock is released during the call.
+ * @param lock Lock on pool mutex.
+ * @return True if some work was done.
+ */
+bool ThreadPool::runNext(std::unique_lock<std::mutex> &lock)
+{
+	if (_job == nullptr || _nextIndex >= _jobSize)
+	{
+		return false;
+	}
+	auto job = _job;
+	auto index = _nextIndex++;
+	++_running;
+	lock.unlock();
+
+	insideJob = true;
+	(*job)(index);
+	insideJob = false;
+
+	lock.lock();
+	--_running;
+	if (_running == 0 && _nextIndex >= _jobSize)
+	{
+		_finished.notify_all();
+	}
+	return true;
+}
+
+/**
+ * Waits for new jobs and helps to finish them.
+ */
+void ThreadPool::workerLoop()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	size_t lastGeneration = _generation;
+	while (true)
+	{
+		_wakeUp.wait(lock, [&]{ return _quit || lastGeneration != _generation; });
+		if (_quit)
+		{
+			return;
+		}
+		lastGeneration = _generation;
+		while (runNext(lock))
+		{
+			// keep going until job is exhausted
+		}
+	}
+}
+
+/**
+ * Calls func for every index in range, spreading calls over all worker threads.
+ * Order of calls is not defined, func need to store its result in a slot owned by given index.
+ * When called from inside another job, everything is done by the current thread.
+ * Func must not throw.
+ * @param size Number of indexes.
+ * @param func Callback that gets index.
+ */
+void ThreadPool::parallelFor(size_t size, const std::function<void(size_t)> &func)
+{
+	if (_threads.empty() || size < 2 || insideJob)
+	{
+		for (size_t i = 0; i < size; ++i)
+		{
+			func(i);
+		}
+		return;
+	}
+
+	std::lock_guard<std::mutex> caller(_callerMutex);
+	std::unique_lock<std::mutex> lock(_mutex);
+	_job = &func;
+	_jobSize = size;
+	_nextIndex = 0;
+	++_generation;
+	_wakeUp.notify_all();
+
+	while (runNext(lock))
+	{
+		// caller work too
+	}
+	_finished.wait(lock, [&]{ return _running == 0 && _nextIndex >= _jobSize; });
+	_job = nullptr;
+	_jobSize = 0;
+	_nextIndex = 0;
+}
+
+/**
+ * Gets pool shared by all game systems.
+ * Size is taken from `oxceWorkerThreads`, zero or less mean one thread less than number of CPU cores.
+ * @return Shared pool.
+ */
+ThreadPool &ThreadPool::getShared()
+{
+	static ThreadPool pool(getWorkerThreadsCount());
+	return pool;
+}
+
+}
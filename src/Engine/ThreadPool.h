@@ -0,0 +1,63 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace OpenXcom
+{
+
+/**
+ * Fixed set of worker threads used to split independent work into chunks.
+ * The calling thread always takes part in the work, and a pool without
+ * any workers simply runs everything in place.
+ * Jobs must not touch game state that other jobs can write to.
+ */
+class ThreadPool
+{
+	std::vector<std::thread> _threads;
+	std::mutex _mutex, _callerMutex;
+	std::condition_variable _wakeUp, _finished;
+	const std::function<void(size_t)> *_job;
+	size_t _jobSize, _nextIndex, _running;
+	size_t _generation;
+	bool _quit;
+
+	/// Main loop of worker thread.
+	void workerLoop();
+	/// Takes next part of current job and runs it, returns false when nothing left.
+	bool runNext(std::unique_lock<std::mutex> &lock);
+public:
+	/// Creates pool with given number of worker threads.
+	ThreadPool(size_t threads);
+	/// Stops and joins all worker threads.
+	~ThreadPool();
+	/// Gets number of worker threads (not counting the caller).
+	size_t getThreadCount() const { return _threads.size(); }
+	/// Calls func for every index in [0, size) and waits until all are done.
+	void parallelFor(size_t size, const std::function<void(size_t)> &func);
+
+	/// Gets pool shared by whole game, created on first use.
+	static ThreadPool &getShared();
+};
+
+}
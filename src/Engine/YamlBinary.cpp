@@ -0,0 +1,249 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "YamlBinary.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+enum BinaryNodeType : Uint8
+{
+	BN_NULL,
+	BN_SCALAR,
+	BN_SEQUENCE,
+	BN_MAP,
+};
+
+}
+
+/**
+ * Creates writer collecting all data in a buffer.
+ */
+YamlBinaryWriter::YamlBinaryWriter() : _flushSize(0)
+{
+
+}
+
+/**
+ * Creates writer passing data to a sink.
+ * @param sink Function receiving written data.
+ * @param flushSize Size of buffer after which data is passed to sink.
+ */
+YamlBinaryWriter::YamlBinaryWriter(std::function<void(const char *, size_t)> sink, size_t flushSize) : _sink(sink), _flushSize(flushSize)
+{
+	_data.reserve(flushSize + 1024);
+}
+
+void YamlBinaryWriter::writeSize(size_t value)
+{
+	while (value >= 0x80)
+	{
+		_data.push_back((char)(0x80 | (value & 0x7F)));
+		value >>= 7;
+	}
+	_data.push_back((char)value);
+	checkFlush();
+}
+
+void YamlBinaryWriter::writeUint64(Uint64 value)
+{
+	for (int i = 0; i < 8; ++i)
+	{
+		_data.push_back((char)(value >> (8 * i)));
+	}
+	checkFlush();
+}
+
+void YamlBinaryWriter::writeString(const std::string &str)
+{
+	writeSize(str.size());
+	writeBytes(str.data(), str.size());
+}
+
+/**
+ * Stores node with all its children.
+ * @param node Node to store.
+ */
+void YamlBinaryWriter::writeNode(const YAML::Node &node)
+{
+	switch (node.Type())
+	{
+	case YAML::NodeType::Scalar:
+		_data.push_back(BN_SCALAR);
+		writeString(node.Tag());
+		writeString(node.Scalar());
+		break;
+	case YAML::NodeType::Sequence:
+		_data.push_back(BN_SEQUENCE);
+		writeString(node.Tag());
+		writeSize(node.size());
+		for (const auto &n : node)
+		{
+			writeNode(n);
+		}
+		break;
+	case YAML::NodeType::Map:
+		_data.push_back(BN_MAP);
+		writeString(node.Tag());
+		writeSize(node.size());
+		for (const auto &n : node)
+		{
+			writeNode(n.first);
+			writeNode(n.second);
+		}
+		break;
+	default:
+		_data.push_back(BN_NULL);
+		writeString(node.Tag());
+		break;
+	}
+}
+
+/**
+ * Passes all buffered data to sink, does nothing if there is no sink.
+ */
+void YamlBinaryWriter::flush()
+{
+	if (_sink && !_data.empty())
+	{
+		_sink(_data.data(), _data.size());
+		_data.clear();
+	}
+}
+
+Uint8 YamlBinaryReader::readByte()
+{
+	if (_pos == _end)
+	{
+		_valid = false;
+		return 0;
+	}
+	return (Uint8)*_pos++;
+}
+
+size_t YamlBinaryReader::readSize()
+{
+	size_t value = 0;
+	for (int shift = 0; _valid && shift < 64; shift += 7)
+	{
+		Uint8 b = readByte();
+		value |= (size_t)(b & 0x7F) << shift;
+		if ((b & 0x80) == 0)
+		{
+			return value;
+		}
+	}
+	_valid = false;
+	return 0;
+}
+
+Uint64 YamlBinaryReader::readUint64()
+{
+	Uint64 value = 0;
+	for (int i = 0; i < 8; ++i)
+	{
+		value |= (Uint64)readByte() << (8 * i);
+	}
+	return value;
+}
+
+std::string YamlBinaryReader::readString()
+{
+	size_t size = readSize();
+	if (!_valid || (size_t)(_end - _pos) < size)
+	{
+		_valid = false;
+		return std::string();
+	}
+	std::string str(_pos, size);
+	_pos += size;
+	return str;
+}
+
+/**
+ * Checks if next bytes are equal to given magic.
+ * @param magic Expected bytes.
+ * @param size Number of bytes.
+ * @return Do they match?
+ */
+bool YamlBinaryReader::readMagic(const char *magic, size_t size)
+{
+	for (size_t i = 0; i < size; ++i)
+	{
+		if (readByte() != (Uint8)magic[i])
+		{
+			_valid = false;
+		}
+	}
+	return _valid;
+}
+
+/**
+ * Recreates node with all its children.
+ * @return Stored node, or null node when data is invalid.
+ */
+YAML::Node YamlBinaryReader::readNode()
+{
+	const Uint8 type = readByte();
+	const std::string tag = readString();
+	if (!_valid)
+	{
+		return YAML::Node();
+	}
+
+	YAML::Node node;
+	switch (type)
+	{
+	case BN_SCALAR:
+		node = YAML::Node(readString());
+		break;
+	case BN_SEQUENCE:
+	{
+		node = YAML::Node(YAML::NodeType::Sequence);
+		for (size_t i = readSize(); _valid && i > 0; --i)
+		{
+			node.push_back(readNode());
+		}
+		break;
+	}
+	case BN_MAP:
+	{
+		node = YAML::Node(YAML::NodeType::Map);
+		for (size_t i = readSize(); _valid && i > 0; --i)
+		{
+			YAML::Node key = readNode();
+			YAML::Node value = readNode();
+			node.force_insert(key, value);
+		}
+		break;
+	}
+	case BN_NULL:
+		node = YAML::Node(YAML::NodeType::Null);
+		break;
+	default:
+		_valid = false;
+		return YAML::Node();
+	}
+	node.SetTag(tag);
+	return node;
+}
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <functional>
+#include <yaml-cpp/yaml.h>
+#include <SDL_types.h>
+
+namespace OpenXcom
+{
+
+/**
+ * Writer of compact binary form of YAML nodes, skipping emitting and parsing of text.
+ * Data is collected in a buffer, if a sink is given the buffer is passed to it
+ * each time it grows over given size, so big trees can be streamed out.
+ */
+class YamlBinaryWriter
+{
+	std::string _data;
+	std::function<void(const char *, size_t)> _sink;
+	size_t _flushSize;
+
+	/// Passes buffer to sink if it is big enough.
+	void checkFlush() { if (_sink && _data.size() >= _flushSize) flush(); }
+public:
+	/// Creates writer collecting all data in a buffer.
+	YamlBinaryWriter();
+	/// Creates writer passing data to a sink.
+	YamlBinaryWriter(std::function<void(const char *, size_t)> sink, size_t flushSize);
+
+	/// Writes raw bytes.
+	void writeBytes(const char *data, size_t size) { _data.append(data, size); checkFlush(); }
+	/// Writes variable length unsigned value.
+	void writeSize(size_t value);
+	/// Writes fixed size 64 bit value.
+	void writeUint64(Uint64 value);
+	/// Writes string with its length.
+	void writeString(const std::string &str);
+	/// Writes node with all its children.
+	void writeNode(const YAML::Node &node);
+	/// Passes all buffered data to sink.
+	void flush();
+
+	/// Gets buffered data.
+	std::string &getData() { return _data; }
+};
+
+/**
+ * Reader of data stored by YamlBinaryWriter, any error stops it and marks it as invalid.
+ */
+class YamlBinaryReader
+{
+	const char *_pos;
+	const char *_end;
+	bool _valid;
+
+public:
+	/// Creates reader of a buffer.
+	YamlBinaryReader(const char *begin, const char *end) : _pos{ begin }, _end{ end }, _valid{ true } { }
+
+	/// Was all data read correctly?
+	bool isValid() const { return _valid; }
+	/// Was all data consumed?
+	bool isEnd() const { return _pos == _end; }
+	/// Gets position of next unread byte.
+	const char *getPos() const { return _pos; }
+
+	/// Reads single byte.
+	Uint8 readByte();
+	/// Reads variable length unsigned value.
+	size_t readSize();
+	/// Reads fixed size 64 bit value.
+	Uint64 readUint64();
+	/// Reads string with its length.
+	std::string readString();
+	/// Checks if next bytes are equal to given magic.
+	bool readMagic(const char *magic, size_t size);
+	/// Reads node with all its children.
+	YAML::Node readNode();
+};
+
+}
@@ -123,6 +123,7 @@
 #include "../Menu/ListSaveState.h"
 #include "../Mod/RuleGlobe.h"
 #include "../Engine/Exception.h"
+#include "../Engine/FrameTrace.h"
 #include "../Mod/AlienDeployment.h"
 #include "../Mod/RuleInterface.h"
 #include "../Mod/RuleVideo.h"
@@ -874,6 +875,7 @@ void GeoscapeState::timeAdvance()
 const std::vector<Craft*>* GeoscapeState::updateActiveCrafts()
 {
 	_activeCrafts.clear();
+	_activeCraftsGrid.clear();
 	for (auto base : *_game->getSavedGame()->getBases())
 	{
 		for (auto craft : *base->getCrafts())
@@ -881,18 +883,35 @@ const std::vector<Craft*>* GeoscapeState::updateActiveCrafts()
 			if (craft->getStatus() == "STR_OUT" && !craft->isDestroyed())
 			{
 				_activeCrafts.push_back(craft);
+				_activeCraftsGrid.insert(craft);
 			}
 		}
 	}
 	return &_activeCrafts;
 }
 
+/**
+ * Gets the active crafts that can be within range of a point,
+ * based on their positions in the last `updateActiveCrafts` call.
+ * Crafts far away are skipped, the exact distance still needs to be checked.
+ * @param lon Longitude of the point.
+ * @param lat Latitude of the point.
+ * @param range Range in radians.
+ * @return Indexes in the list of active crafts, in the same order.
+ */
+const std::vector<size_t>* GeoscapeState::getNearActiveCrafts(double lon, double lat, double range)
+{
+	_activeCraftsGrid.query(lon, lat, range, _nearCrafts);
+	return &_nearCrafts;
+}
+
 /**
  * Takes care of any game logic that has to
  * run every game second, like craft movement.
  */
 void GeoscapeState::time5Seconds()
 {
+	FrameTraceScope trace("GeoscapeState::time5Seconds");
 	// If in "slow mode", handle UFO hunting and escorting logic every 5 seconds, not only every 10 minutes
 	if ((_timeSpeed == _btn5Secs || _timeSpeed == _btn1Min) && _game->getMod()->getHunterKillerFastRetarget())
 	{
@@ -1466,6 +1485,7 @@ struct SetRetaliationTarget
  */
 void GeoscapeState::time10Minutes()
 {
+	FrameTraceScope trace("GeoscapeState::time10Minutes");
 	for (std::vector<Base*>::iterator i = _game->getSavedGame()->getBases()->begin(); i != _game->getSavedGame()->getBases()->end(); ++i)
 	{
 		// Fuel consumption for XCOM craft.
@@ -1576,8 +1596,9 @@ void GeoscapeState::ufoHuntingAndEscorting()
 			}
 
 			// look for more attractive target
-			for (auto craft : *crafts)
+			for (auto index : *getNearActiveCrafts((*ufo)->getLongitude(), (*ufo)->getLatitude(), Nautical((*ufo)->getCraftStats().radarRange)))
 			{
+				Craft *craft = crafts->at(index);
 				if (!craft->getMissionComplete() && !craft->getRules()->isUndetectable())
 				{
 					int tmpAttraction = craft->getHunterKillerAttraction((*ufo)->getHuntMode());
@@ -1656,8 +1677,9 @@ void GeoscapeState::baseHunting()
 			{
 				// Look for nearby craft
 				bool started = false;
-				for (auto craft : *crafts)
+				for (auto index : *getNearActiveCrafts((*ab)->getLongitude(), (*ab)->getLatitude(), Nautical((*ab)->getDeployment()->getBaseDetectionRange())))
 				{
+					Craft *craft = crafts->at(index);
 					// Craft is flying (i.e. not in base)
 					if (craft->getStatus() == "STR_OUT" && !craft->isDestroyed() && !craft->getRules()->isUndetectable())
 					{
@@ -1769,6 +1791,7 @@ bool GeoscapeState::processMissionSite(MissionSite *site)
  */
 void GeoscapeState::time30Minutes()
 {
+	FrameTraceScope trace("GeoscapeState::time30Minutes");
 	// Decrease mission countdowns
 	for (auto am : _game->getSavedGame()->getAlienMissions())
 	{
@@ -1992,6 +2015,7 @@ void GeoscapeState::time30Minutes()
  */
 void GeoscapeState::time1Hour()
 {
+	FrameTraceScope trace("GeoscapeState::time1Hour");
 	// Handle craft maintenance
 	for (std::vector<Base*>::iterator i = _game->getSavedGame()->getBases()->begin(); i != _game->getSavedGame()->getBases()->end(); ++i)
 	{
@@ -2200,6 +2224,7 @@ void GenerateSupplyMission::operator()(AlienBase *base) const
  */
 void GeoscapeState::time1Day()
 {
+	FrameTraceScope trace("GeoscapeState::time1Day");
 	SavedGame *saveGame = _game->getSavedGame();
 	Mod *mod = _game->getMod();
 	bool psiStrengthEval = (Options::psiStrengthEval && saveGame->isResearched(mod->getPsiRequirements()));
@@ -2652,6 +2677,7 @@ void GeoscapeState::time1Day()
  */
 void GeoscapeState::time1Month()
 {
+	FrameTraceScope trace("GeoscapeState::time1Month");
 	_game->getSavedGame()->addMonth();
 
 	// Determine alien mission for this month.
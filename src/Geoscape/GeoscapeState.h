@@ -18,6 +18,7 @@
  * along with OpenXcom.  If not, see <http:///www.gnu.org/licenses/>.
  */
 #include "../Engine/State.h"
+#include "TargetGrid.h"
 #include <list>
 
 namespace OpenXcom
@@ -60,11 +61,15 @@ private:
 	std::list<State*> _popups;
 	std::list<DogfightState*> _dogfights, _dogfightsToBeStarted;
 	std::vector<Craft*> _activeCrafts;
+	TargetGrid _activeCraftsGrid;
+	std::vector<size_t> _nearCrafts;
 	size_t _minimizedDogfights;
 	int _slowdownCounter;
 
 	/// Update list of active crafts.
 	const std::vector<Craft*>* updateActiveCrafts();
+	/// Gets active crafts that can be within range of a point.
+	const std::vector<size_t>* getNearActiveCrafts(double lon, double lat, double range);
 
 	void cbxRegionChange(Action *action);
 	void cbxZoneChange(Action *action);
@@ -55,12 +55,14 @@
 #include "../Mod/Texture.h"
 #include "../Interface/Cursor.h"
 #include "../Engine/Screen.h"
+#include "../Engine/FrameTrace.h"
 
 namespace OpenXcom
 {
 
 const double Globe::ROTATE_LONGITUDE = 0.10;
 const double Globe::ROTATE_LATITUDE = 0.06;
+const double Globe::SHADOW_SUN_THRESHOLD = 0.008;
 
 Uint8 Globe::OCEAN_COLOR;
 bool Globe::OCEAN_SHADING;
@@ -288,25 +290,19 @@ struct CreateShadow
 		return Globe::OCEAN_SHADING && dest >= Globe::OCEAN_COLOR && dest < Globe::OCEAN_COLOR + 32;
 	}
 
-	static inline void func(Uint8& dest, const Cord& earth, const Cord& sun, const Sint16& noise)
+	/**
+	 * Calculates shadow of one pixel, it's applied to the globe
+	 * later by `helper::ShaderRowKernels::globeShadow`.
+	 */
+	static inline void func(Uint8& shadow, const Cord& earth, const Cord& sun, const Sint16& noise)
 	{
-		if (dest && earth.z)
+		if (earth.z)
 		{
-			const Uint8 shadow = getShadowValue(earth, sun, noise);
-			//this pixel is ocean
-			if (isOcean(dest))
-			{
-				dest = getOceanShadow(shadow);
-			}
-			//this pixel is land
-			else
-			{
-				dest = getLandShadow(dest, shadow);
-			}
+			shadow = getShadowValue(earth, sun, noise);
 		}
 		else
 		{
-			dest = 0;
+			shadow = helper::GlobeShadowOutside;
 		}
 	}
 };
@@ -943,13 +939,19 @@ void Globe::rotate()
  */
 void Globe::draw()
 {
-	if (_redraw)
+	FrameTraceScope trace("Globe::draw");
+	bool redraw = _redraw;
+	Surface::draw();
+	if (!drawLandCache())
 	{
-		cachePolygons();
+		if (redraw || Options::oxceGlobeLandCache)
+		{
+			cachePolygons();
+		}
+		drawOcean();
+		drawLand();
+		saveLandCache();
 	}
-	Surface::draw();
-	drawOcean();
-	drawLand();
 	drawRadars();
 	drawFlights();
 	drawShadow();
@@ -994,6 +996,48 @@ void Globe::drawLand()
 	}
 }
 
+/**
+ * Restores the ocean and land rendered for the current view,
+ * so the globe doesn't have to reproject and rasterize all
+ * the polygons again when only the time of day has changed.
+ * @return True if the current view was in the cache.
+ */
+bool Globe::drawLandCache()
+{
+	if (!Options::oxceGlobeLandCache || _zoom >= _landCache.size())
+		return false;
+
+	const LandCache &land = _landCache[_zoom];
+	if (land.pixels.empty() || land.lon != _cenLon || land.lat != _cenLat || land.radius != _radius || land.x != _cenX || land.y != _cenY)
+		return false;
+
+	lock();
+	std::copy(land.pixels.begin(), land.pixels.end(), getRaw(0, 0));
+	unlock();
+	return true;
+}
+
+/**
+ * Stores the ocean and land rendered for the current view
+ * in the cache of the current zoom level.
+ */
+void Globe::saveLandCache()
+{
+	if (!Options::oxceGlobeLandCache || _zoom >= _landCache.size())
+		return;
+
+	LandCache &land = _landCache[_zoom];
+	land.lon = _cenLon;
+	land.lat = _cenLat;
+	land.radius = _radius;
+	land.x = _cenX;
+	land.y = _cenY;
+	lock();
+	const Uint8 *pixels = getRaw(0, 0);
+	land.pixels.assign(pixels, pixels + getPitch() * getHeight());
+	unlock();
+}
+
 /**
  * Get position of sun from point on globe
  * @param lon longitude of position
@@ -1050,17 +1094,45 @@ Cord Globe::getSunDirection(double lon, double lat) const
 }
 
 
+/**
+ * Renders the day/night shadow over the globe. Shadow values are
+ * kept between redraws and only calculated again when the globe
+ * moves or the sun has moved far enough to change the shading.
+ */
 void Globe::drawShadow()
 {
-	auto earth = ShaderMove<Cord>(SurfaceRaw<Cord>(_earthData[_zoom], getWidth(), getHeight()));
-	auto noise = ShaderRepeat<Sint16>(SurfaceRaw<Sint16>(static_data.random_noise, static_data.random_surf_size, static_data.random_surf_size));
+	const Cord sun = getSunDirection(_cenLon, _cenLat);
+	auto sunMoved = [&]
+	{
+		Cord sunMove = sun;
+		sunMove -= _shadowCache.sun;
+		return sunMove.norm() > SHADOW_SUN_THRESHOLD;
+	};
+	if (_shadowCache.mask.empty() || _shadowCache.zoom != _zoom || _shadowCache.lon != _cenLon || _shadowCache.lat != _cenLat ||
+		_shadowCache.x != _cenX || _shadowCache.y != _cenY || sunMoved())
+	{
+		auto earth = ShaderMove<Cord>(SurfaceRaw<Cord>(_earthData[_zoom], getWidth(), getHeight()));
+		auto noise = ShaderRepeat<Sint16>(SurfaceRaw<Sint16>(static_data.random_noise, static_data.random_surf_size, static_data.random_surf_size));
 
-	earth.setMove(_cenX-getWidth()/2, _cenY-getHeight()/2);
+		earth.setMove(_cenX-getWidth()/2, _cenY-getHeight()/2);
 
+		_shadowCache.mask.resize(getWidth() * getHeight());
+		ShaderDraw<CreateShadow>(ShaderSurface(SurfaceRaw<Uint8>(_shadowCache.mask, getWidth(), getHeight())), earth, ShaderScalar(sun), noise);
+		_shadowCache.sun = sun;
+		_shadowCache.zoom = _zoom;
+		_shadowCache.lon = _cenLon;
+		_shadowCache.lat = _cenLat;
+		_shadowCache.x = _cenX;
+		_shadowCache.y = _cenY;
+	}
+
+	const helper::ShaderRowKernels &kernels = helper::getShaderRowKernels();
 	lock();
-	ShaderDraw<CreateShadow>(ShaderSurface(this), earth, ShaderScalar(getSunDirection(_cenLon, _cenLat)), noise);
+	for (int y = 0; y < getHeight(); ++y)
+	{
+		kernels.globeShadow(getRaw(0, y), &_shadowCache.mask[y * getWidth()], getWidth(), OCEAN_COLOR, OCEAN_SHADING);
+	}
 	unlock();
-
 }
 
 
@@ -2079,6 +2151,9 @@ void Globe::setupRadii(int width, int height)
 	_radiusStep = (_zoomRadius[DOGFIGHT_ZOOM] - _zoomRadius[0]) / 10.0;
 
 	_earthData.resize(_zoomRadius.size());
+	_landCache.clear();
+	_landCache.resize(_zoomRadius.size());
+	_shadowCache.mask.clear();
 	//filling normal field for each radius
 
 	for (size_t r = 0; r<_zoomRadius.size(); ++r)
@@ -44,6 +44,23 @@ class Craft;
 class Globe : public InteractiveSurface
 {
 private:
+	/// Ocean and land pixels rendered for a given view.
+	struct LandCache
+	{
+		double lon, lat, radius;
+		Sint16 x, y;
+		std::vector<Uint8> pixels;
+	};
+	/// Shadow values calculated for a given view and sun position.
+	struct ShadowCache
+	{
+		Cord sun = Cord(0.0, 0.0, 0.0);
+		double lon = 0.0, lat = 0.0;
+		size_t zoom = 0;
+		Sint16 x = 0, y = 0;
+		/// Empty until first draw, other fields are only valid after that.
+		std::vector<Uint8> mask;
+	};
 	static const int NUM_LANDSHADES = 48;
 	static const int NUM_SEASHADES = 72;
 	static const int NEAR_RADIUS = 25;
@@ -52,6 +69,8 @@ private:
 	static const int CITY_MARKER = 8;
 	static const double ROTATE_LONGITUDE;
 	static const double ROTATE_LATITUDE;
+	/// How far the sun can move (about a quarter of shade) before the shadow is calculated again.
+	static const double SHADOW_SUN_THRESHOLD;
 
 	RuleGlobe *_rules;
 	Sint16 _cenX, _cenY;
@@ -71,6 +90,10 @@ private:
 	std::vector<std::vector<Cord> > _earthData;
 	///list of dimension of earth on screen per zoom level
 	std::vector<double> _zoomRadius;
+	///last rendered ocean and land per zoom level
+	std::vector<LandCache> _landCache;
+	///last calculated shadow
+	ShadowCache _shadowCache;
 
 	bool _isMouseScrolling, _isMouseScrolled;
 	int _xBeforeMouseScrolling, _yBeforeMouseScrolling;
@@ -103,6 +126,10 @@ private:
 	void drawTarget(Target *target, Surface *surface);
 	/// Set up the radius of earth and stuff.
 	void setupRadii(int width, int height);
+	/// Restores the ocean and land from the cache.
+	bool drawLandCache();
+	/// Stores the ocean and land in the cache.
+	void saveLandCache();
 public:
 	static Uint8 OCEAN_COLOR;
 	static bool OCEAN_SHADING;
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TargetGrid.h"
+#include <algorithm>
+#include <cmath>
+#include "../fmath.h"
+#include "../Savegame/Target.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Initializes an empty grid.
+ */
+TargetGrid::TargetGrid() : _cells(LAT_CELLS * LON_CELLS), _size(0)
+{
+}
+
+/**
+ *
+ */
+TargetGrid::~TargetGrid()
+{
+}
+
+/**
+ * Gets the row of the cell containing a latitude.
+ * @param lat Latitude in radians.
+ * @return Row index.
+ */
+int TargetGrid::getRow(double lat)
+{
+	return Clamp((int)std::floor((lat + M_PI / 2) * LAT_CELLS / M_PI), 0, LAT_CELLS - 1);
+}
+
+/**
+ * Gets the column of the cell containing a longitude.
+ * @param lon Longitude in radians, can be outside 0 to 2xPI.
+ * @return Column index.
+ */
+int TargetGrid::getColumn(double lon)
+{
+	int column = (int)std::floor(lon * LON_CELLS / (2 * M_PI)) % LON_CELLS;
+	if (column < 0)
+	{
+		column += LON_CELLS;
+	}
+	return column;
+}
+
+/**
+ * Removes all targets from the grid, keeping the memory
+ * of the cells around for the next use.
+ */
+void TargetGrid::clear()
+{
+	for (std::vector<size_t> &cell : _cells)
+	{
+		cell.clear();
+	}
+	_size = 0;
+}
+
+/**
+ * Adds a target to the grid at its current position.
+ * The grid needs to be rebuilt when targets move.
+ * @param target Pointer to target.
+ */
+void TargetGrid::insert(const Target *target)
+{
+	_cells[getRow(target->getLatitude()) * LON_CELLS + getColumn(target->getLongitude())].push_back(_size);
+	_size++;
+}
+
+/**
+ * Gets the targets in all cells that touch a circle around a point.
+ * This can include targets outside the range, so the caller still
+ * needs to check the exact distance.
+ * @param lon Longitude of the point.
+ * @param lat Latitude of the point.
+ * @param range Range in radians (great circle distance).
+ * @param result Indexes of the targets, in the order they were inserted.
+ */
+void TargetGrid::query(double lon, double lat, double range, std::vector<size_t> &result) const
+{
+	result.clear();
+	// small margin for rounding errors
+	range = std::max(range, 0.0) + 1e-6;
+
+	const double latMin = lat - range;
+	const double latMax = lat + range;
+	bool allColumns = latMin <= -M_PI / 2 || latMax >= M_PI / 2 || range >= M_PI / 2;
+	double lonRange = M_PI;
+	if (!allColumns)
+	{
+		// widest part of the circle is at the latitude nearest to the equator
+		const double maxSin = std::sin(range) / std::cos(std::max(std::fabs(latMin), std::fabs(latMax)));
+		if (maxSin >= 1.0)
+		{
+			allColumns = true;
+		}
+		else
+		{
+			lonRange = std::asin(maxSin);
+			allColumns = lonRange * LON_CELLS / (2 * M_PI) >= LON_CELLS / 2 - 1;
+		}
+	}
+
+	const int rowMin = getRow(latMin);
+	const int rowMax = getRow(latMax);
+	const int columnFirst = allColumns ? 0 : getColumn(lon - lonRange);
+	const int columns = allColumns ? LON_CELLS : (getColumn(lon + lonRange) - columnFirst + LON_CELLS) % LON_CELLS + 1;
+	for (int row = rowMin; row <= rowMax; ++row)
+	{
+		for (int i = 0; i < columns; ++i)
+		{
+			const std::vector<size_t> &cell = _cells[row * LON_CELLS + (columnFirst + i) % LON_CELLS];
+			result.insert(result.end(), cell.begin(), cell.end());
+		}
+	}
+	std::sort(result.begin(), result.end());
+}
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <cstddef>
+
+namespace OpenXcom
+{
+
+class Target;
+
+/**
+ * Splits the globe in cells of latitude and longitude and keeps
+ * a list of targets in each of them, so range checks only need
+ * to look at targets that are close enough.
+ * Targets are identified by the order they were inserted in.
+ */
+class TargetGrid
+{
+private:
+	static const int LAT_CELLS = 36;
+	static const int LON_CELLS = 72;
+	std::vector<std::vector<size_t> > _cells;
+	size_t _size;
+
+	/// Gets the row of the cell containing a latitude.
+	static int getRow(double lat);
+	/// Gets the column of the cell containing a longitude.
+	static int getColumn(double lon);
+public:
+	/// Creates an empty grid.
+	TargetGrid();
+	/// Cleans up the grid.
+	~TargetGrid();
+	/// Removes all targets from the grid.
+	void clear();
+	/// Adds a target to the grid.
+	void insert(const Target *target);
+	/// Gets the number of targets in the grid.
+	size_t size() const { return _size; }
+	/// Gets the targets that can be within range of a point.
+	void query(double lon, double lat, double range, std::vector<size_t> &result) const;
+};
+
+}
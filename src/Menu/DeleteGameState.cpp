@@ -27,6 +27,7 @@
 #include "../Engine/Options.h"
 #include "ErrorMessageState.h"
 #include "../Savegame/SavedGame.h"
+#include "../Savegame/SaveCatalog.h"
 #include "../Mod/RuleInterface.h"
 
 namespace OpenXcom
@@ -97,7 +98,13 @@ void DeleteGameState::btnNoClick(Action *)
 void DeleteGameState::btnYesClick(Action *)
 {
 	_game->popState();
-	if (!CrossPlatform::deleteFile(_filename))
+	if (CrossPlatform::deleteFile(_filename))
+	{
+		SaveCatalog &catalog = SaveCatalog::getInstance();
+		catalog.remove(CrossPlatform::baseFilename(_filename));
+		catalog.save();
+	}
+	else
 	{
 		std::string error = tr("STR_DELETE_UNSUCCESSFUL");
 		if (_origin != OPT_BATTLESCAPE)
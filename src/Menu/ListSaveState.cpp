@@ -27,6 +27,7 @@
 #include "../Interface/TextEdit.h"
 #include "../Interface/TextButton.h"
 #include "SaveGameState.h"
+#include "../Savegame/SaveCatalog.h"
 
 namespace OpenXcom
 {
@@ -181,7 +182,10 @@ void ListSaveState::saveGame()
 			}
 			std::string oldPath = Options::getMasterUserFolder() + oldFilename;
 			std::string newPath = Options::getMasterUserFolder() + newFilename + ".sav";
-			CrossPlatform::moveFile(oldPath, newPath);
+			if (CrossPlatform::moveFile(oldPath, newPath))
+			{
+				SaveCatalog::getInstance().remove(oldFilename);
+			}
 		}
 	}
 	else
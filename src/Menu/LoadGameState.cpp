@@ -20,6 +20,7 @@
 #include <sstream>
 #include "../Engine/Logger.h"
 #include "../Savegame/SavedBattleGame.h"
+#include "../Savegame/BackgroundSaver.h"
 #include "../Engine/Game.h"
 #include "../Engine/Exception.h"
 #include "../Engine/Options.h"
@@ -162,6 +163,9 @@ void LoadGameState::think()
 		// Reset touch flags
 		_game->resetTouchButtonFlags();
 
+		// Make sure an autosave is not still being written
+		BackgroundSaver::getInstance().wait();
+
 		// Load the game
 		SavedGame *s = new SavedGame();
 		try
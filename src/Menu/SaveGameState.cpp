@@ -30,6 +30,8 @@
 #include "ErrorMessageState.h"
 #include "MainMenuState.h"
 #include "../Savegame/SavedGame.h"
+#include "../Savegame/SaveCatalog.h"
+#include "../Savegame/BackgroundSaver.h"
 #include "../Mod/Mod.h"
 #include "../Mod/RuleInterface.h"
 
@@ -136,11 +138,16 @@ void SaveGameState::buildUi(SDL_Color *palette)
 void SaveGameState::think()
 {
 	State::think();
+	bool background = Options::oxceBackgroundAutosave && (_type == SAVE_AUTO_GEOSCAPE || _type == SAVE_AUTO_BATTLESCAPE);
 	// Make sure it gets drawn properly
-	if (_firstRun < 10)
+	if (!background && _firstRun < 10)
 	{
 		_firstRun++;
 	}
+	// Autosaves are written in background, only wait if the previous one is not done yet
+	else if (background && BackgroundSaver::getInstance().isBusy())
+	{
+	}
 	else
 	{
 		_game->popState();
@@ -168,6 +175,16 @@ void SaveGameState::think()
 		// Save the game
 		try
 		{
+			if (background)
+			{
+				std::string lastError = BackgroundSaver::getInstance().takeError();
+				_game->getSavedGame()->saveInBackground(_filename, _game->getMod());
+				if (!lastError.empty())
+				{
+					error(lastError);
+				}
+				return;
+			}
 			std::string backup = _filename + ".bak";
 			_game->getSavedGame()->save(backup, _game->getMod());
 			std::string fullPath = Options::getMasterUserFolder() + _filename;
@@ -176,6 +193,7 @@ void SaveGameState::think()
 			{
 				throw Exception("Save backed up in " + backup);
 			}
+			SaveCatalog::getInstance().update(_filename);
 
 			if (_type == SAVE_IRONMAN_END)
 			{
@@ -152,6 +152,15 @@ bool ExtraSprites::isLoaded() const
 	return _loaded;
 }
 
+/**
+ * Marks the sprite as not loaded, so it will be
+ * loaded again next time it's requested.
+ */
+void ExtraSprites::unload()
+{
+	_loaded = false;
+}
+
 /**
  * Determines if an image file is an acceptable format for the game.
  * @param filename Image filename.
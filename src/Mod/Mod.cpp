@@ -18,6 +18,7 @@
  */
 #include "Mod.h"
 #include "ModScript.h"
+#include "ModRulesetCache.h"
 #include <algorithm>
 #include <sstream>
 #include <climits>
@@ -33,6 +34,7 @@
 #include "../Engine/Music.h"
 #include "../Engine/GMCat.h"
 #include "../Engine/SoundSet.h"
+#include "../Engine/ThreadPool.h"
 #include "../Engine/Sound.h"
 #include "../Interface/TextButton.h"
 #include "../Interface/Window.h"
@@ -376,6 +378,7 @@ public:
  * Creates an empty mod.
  */
 Mod::Mod() :
+	_transientSurfacesSize(0),
 	_inventoryOverlapsPaperdoll(false),
 	_maxViewDistance(20), _maxDarknessToSeeUnits(9), _maxStaticLightDistance(16), _maxDynamicLightDistance(24), _enhancedLighting(0),
 	_costHireEngineer(0), _costHireScientist(0),
@@ -829,10 +832,110 @@ void Mod::lazyLoadSurface(const std::string &name, int width, int height)
  */
 Surface *Mod::getSurface(const std::string &name, bool error, int width, int height)
 {
+	if (!_transientSurfaces.empty())
+	{
+		// regular access keeps the surface around for good
+		for (std::list<std::pair<std::string, size_t> >::iterator i = _transientSurfaces.begin(); i != _transientSurfaces.end(); ++i)
+		{
+			if (i->first == name)
+			{
+				_transientSurfacesSize -= i->second;
+				_transientSurfaces.erase(i);
+				break;
+			}
+		}
+	}
 	lazyLoadSurface(name, width, height);
 	return getRule(name, "Sprite", _surfaces, error);
 }
 
+/**
+ * Returns a specific surface from the mod, for images that are
+ * only blitted once and rarely needed again (eg. Ufopaedia images
+ * or soldier avatars). Images loaded on demand this way are kept
+ * in a least-recently-used list and freed again when they exceed
+ * the memory budget.
+ * @note Don't store the returned pointer, it's only guaranteed
+ * to be valid until the next call to this function.
+ * @param name Name of the surface.
+ * @param error Throw an error if the surface is missing.
+ * @return Pointer to the surface.
+ */
+Surface *Mod::getSurfaceTransient(const std::string &name, bool error)
+{
+	if (!Options::lazyLoadResources || Options::oxceLazyLoadBudget <= 0)
+	{
+		return getSurface(name, error);
+	}
+
+	for (std::list<std::pair<std::string, size_t> >::iterator i = _transientSurfaces.begin(); i != _transientSurfaces.end(); ++i)
+	{
+		if (i->first == name)
+		{
+			_transientSurfaces.splice(_transientSurfaces.begin(), _transientSurfaces, i);
+			return getRule(name, "Sprite", _surfaces, error);
+		}
+	}
+
+	// only surfaces made entirely from single image sprites we load ourselves can be freed again
+	std::map<std::string, std::vector<ExtraSprites *> >::const_iterator sprites = _extraSprites.find(name);
+	bool transient = sprites != _extraSprites.end() && _surfaces.find(name) == _surfaces.end();
+	if (transient)
+	{
+		for (std::vector<ExtraSprites*>::const_iterator j = sprites->second.begin(); j != sprites->second.end(); ++j)
+		{
+			if (!(*j)->getSingleImage() || (*j)->isLoaded())
+			{
+				transient = false;
+				break;
+			}
+		}
+	}
+
+	lazyLoadSurface(name);
+	Surface *surface = getRule(name, "Sprite", _surfaces, error);
+	if (transient && surface != 0)
+	{
+		SDL_Surface *s = surface->getSurface();
+		size_t size = (size_t)s->pitch * s->h;
+		_transientSurfaces.push_front(std::make_pair(name, size));
+		_transientSurfacesSize += size;
+		trimTransientSurfaces();
+	}
+	return surface;
+}
+
+/**
+ * Frees the least recently used transient surfaces until
+ * they fit in the memory budget again. The most recent one
+ * is always kept, since the caller is still using it.
+ */
+void Mod::trimTransientSurfaces()
+{
+	size_t budget = (size_t)std::max(0, Options::oxceLazyLoadBudget) * 1024 * 1024;
+	while (_transientSurfaces.size() > 1 && _transientSurfacesSize > budget)
+	{
+		const std::pair<std::string, size_t> &last = _transientSurfaces.back();
+		std::map<std::string, Surface*>::iterator i = _surfaces.find(last.first);
+		if (i != _surfaces.end())
+		{
+			delete i->second;
+			_surfaces.erase(i);
+		}
+		std::map<std::string, std::vector<ExtraSprites *> >::const_iterator sprites = _extraSprites.find(last.first);
+		if (sprites != _extraSprites.end())
+		{
+			for (std::vector<ExtraSprites*>::const_iterator j = sprites->second.begin(); j != sprites->second.end(); ++j)
+			{
+				(*j)->unload();
+			}
+		}
+		Log(LOG_VERBOSE) << "Freeing transient surface: " << last.first;
+		_transientSurfacesSize -= last.second;
+		_transientSurfaces.pop_back();
+	}
+}
+
 /**
  * Returns a specific surface set from the mod.
  * @param name Name of the surface set.
@@ -950,9 +1053,35 @@ void Mod::playMusic(const std::string &name, int id)
  */
 SoundSet *Mod::getSoundSet(const std::string &name, bool error) const
 {
+	lazyLoadSoundSet(name);
 	return getRule(name, "Sound Set", _sounds, error);
 }
 
+/**
+ * Loads any extra sounds associated to a sound set when
+ * it's first requested.
+ * @param name Sound set name.
+ */
+void Mod::lazyLoadSoundSet(const std::string &name) const
+{
+	if (Options::lazyLoadResources && !Options::mute && _loadedSoundSets.insert(name).second)
+	{
+		for (std::vector< std::pair<std::string, ExtraSounds *> >::const_iterator i = _extraSounds.begin(); i != _extraSounds.end(); ++i)
+		{
+			if (i->first == name)
+			{
+				SoundSet *set = 0;
+				std::map<std::string, SoundSet*>::iterator j = _sounds.find(name);
+				if (j != _sounds.end())
+				{
+					set = j->second;
+				}
+				_sounds[name] = i->second->loadSoundSet(set);
+			}
+		}
+	}
+}
+
 /**
  * Returns a specific sound from the mod.
  * @param set Name of the sound set.
@@ -1421,7 +1550,7 @@ void Mod::loadSoundOffset(const std::string &parent, int& sound, const YAML::Nod
 {
 	if (node)
 	{
-		loadOffsetNode(parent, sound, node, getSoundSet(set)->getMaxSharedSounds(), set, 1);
+		loadOffsetNode(parent, sound, node, getRule(set, "Sound Set", _sounds, true)->getMaxSharedSounds(), set, 1);
 	}
 }
 
@@ -1436,7 +1565,7 @@ void Mod::loadSoundOffset(const std::string &parent, std::vector<int>& sounds, c
 {
 	if (node)
 	{
-		int maxShared = getSoundSet(set)->getMaxSharedSounds();
+		int maxShared = getRule(set, "Sound Set", _sounds, true)->getMaxSharedSounds();
 		sounds.clear();
 		if (isListHelper(node))
 		{
@@ -1732,6 +1861,24 @@ void Mod::loadAll()
 	_soundOffsetBattle = _sounds["BATTLE.CAT"]->getMaxSharedSounds();
 	_soundOffsetGeo = _sounds["GEO.CAT"]->getMaxSharedSounds();
 
+	// files that did not change from last run are loaded from binary cache instead of parsing YAML
+	Uint64 modsKey = ModRulesetCache::hash(nullptr, 0);
+	for (const auto& data : _modData)
+	{
+		modsKey = ModRulesetCache::hash(data.name, modsKey);
+		modsKey = ModRulesetCache::hash(data.info->getVersion(), modsKey);
+	}
+	ModRulesetCache rulesetCache(Options::getUserFolder() + "rulesets.cache", modsKey);
+	if (Options::oxceRulesetCache)
+	{
+		// nodes rebuilt from cache have no source marks, errors in cached files can't report line numbers
+		Log(LOG_INFO) << "Ruleset cache enabled, line numbers are not available for files loaded from it.";
+		rulesetCache.load();
+	}
+
+	Log(LOG_INFO) << "Parsing rulesets...";
+	auto rulesetDocs = parseRulesetFiles(mods, Options::oxceRulesetCache ? &rulesetCache : nullptr);
+
 	Log(LOG_INFO) << "Loading rulesets...";
 	// load rest rulesets
 	for (size_t i = 0; mods.size() > i; ++i)
@@ -1740,7 +1887,10 @@ void Mod::loadAll()
 		{
 			_modCurrent = &_modData.at(i);
 			_scriptGlobal->setMod((int)_modCurrent->offset);
-			loadMod(mods[i].second, parser);
+			_scriptGlobal->setModName(_modCurrent->name);
+			loadMod(rulesetDocs[i], parser);
+			// free memory of trees that are not needed any more
+			rulesetDocs[i].clear();
 		}
 		catch (Exception &e)
 		{
@@ -1946,26 +2096,37 @@ void Mod::loadAll()
 			frame->convertTo32Bits(frame, _palettes["PAL_BATTLESCAPE"]->getColors(), true); // use the palette passed in
 		}
 	}
+
+	// everything loaded correctly, cache can be updated
+	if (Options::oxceRulesetCache)
+	{
+		rulesetCache.save();
+	}
 }
 
 /**
  * Loads a list of rulesets from YAML files for the mod at the specified index. The first
  * mod loaded should be the master at index 0, then 1, and so on.
- * @param rulesetFiles List of rulesets to load.
+ * @param rulesetFiles List of parsed rulesets to load.
  * @param parsers Object with all available parsers.
  */
-void Mod::loadMod(const std::vector<FileMap::FileRecord> &rulesetFiles, ModScript &parsers)
+void Mod::loadMod(const std::vector<RulesetDocument> &rulesetFiles, ModScript &parsers)
 {
 	for (auto i = rulesetFiles.begin(); i != rulesetFiles.end(); ++i)
 	{
-		Log(LOG_VERBOSE) << "- " << i->fullpath;
+		Log(LOG_VERBOSE) << "- " << i->file->fullpath;
 		try
 		{
-			loadFile(*i, parsers);
+			if (i->error)
+			{
+				Log(LOG_FATAL) << "Error loading file '" << i->file->fullpath << "'";
+				std::rethrow_exception(i->error);
+			}
+			loadFile(i->doc, parsers);
 		}
 		catch (YAML::Exception &e)
 		{
-			throw Exception(i->fullpath + ": " + std::string(e.what()));
+			throw Exception(i->file->fullpath + ": " + std::string(e.what()));
 		}
 	}
 
@@ -2027,6 +2188,56 @@ void Mod::loadMod(const std::vector<FileMap::FileRecord> &rulesetFiles, ModScrip
 	}
 }
 
+/**
+ * Parses all ruleset files of all mods. Parsing of one file does not depend on others,
+ * so files are split between worker threads, only applying them needs to follow mod order.
+ * Errors are stored and logged and rethrown on main thread when given file is loaded,
+ * workers must not log anything as logger is not thread safe.
+ * @param mods Ruleset files grouped by mod.
+ * @param cache Cache of parsed files, can be null.
+ * @return Parsed files grouped by mod.
+ */
+std::vector<std::vector<Mod::RulesetDocument>> Mod::parseRulesetFiles(const FileMap::RSOrder &mods, ModRulesetCache *cache)
+{
+	std::vector<std::vector<RulesetDocument>> result(mods.size());
+	std::vector<RulesetDocument*> docs;
+	for (size_t i = 0; i < mods.size(); ++i)
+	{
+		result[i].resize(mods[i].second.size());
+		for (size_t j = 0; j < mods[i].second.size(); ++j)
+		{
+			result[i][j].file = &mods[i].second[j];
+			docs.push_back(&result[i][j]);
+		}
+	}
+
+	auto parse = [&](size_t i)
+	{
+		auto& d = *docs[i];
+		try
+		{
+			d.doc = cache ? cache->getYAML(*d.file) : YAML::Load(*d.file->readIStream());
+		}
+		catch (...)
+		{
+			d.error = std::current_exception();
+		}
+	};
+
+	if (Options::oxceThreadedLoading)
+	{
+		ThreadPool::getShared().parallelFor(docs.size(), parse);
+	}
+	else
+	{
+		for (size_t i = 0; i < docs.size(); ++i)
+		{
+			parse(i);
+		}
+	}
+	return result;
+}
+
 /**
  * Loads a ruleset from a YAML file that have basic resources configuration.
  * @param filename YAML filename.
@@ -2120,13 +2331,11 @@ void Mod::loadConstants(const YAML::Node &node)
 /**
  * Loads a ruleset's contents from a YAML file.
  * Rules that match pre-existing rules overwrite them.
- * @param filename YAML filename.
+ * @param doc Parsed YAML file.
  * @param parsers Object with all available parsers.
  */
-void Mod::loadFile(const FileMap::FileRecord &filerec, ModScript &parsers)
+void Mod::loadFile(const YAML::Node &doc, ModScript &parsers)
 {
-	auto doc = filerec.getYAML();
-
 	if (const YAML::Node &extended = doc["extended"])
 	{
 		_scriptGlobal->load(extended);
@@ -2400,7 +2609,7 @@ void Mod::loadFile(const FileMap::FileRecord &filerec, ModScript &parsers)
 			}
 		}
 	}
-	auto loadStartingBase = [](YAML::Node &docRef, const std::string &startingBaseType, YAML::Node &destRef)
+	auto loadStartingBase = [](const YAML::Node &docRef, const std::string &startingBaseType, YAML::Node &destRef)
 	{
 		// Bases can't be copied, so for savegame purposes we store the node instead
 		YAML::Node base = docRef[startingBaseType];
@@ -5222,7 +5431,7 @@ void Mod::loadExtraResources()
 		}
 	}
 
-	if (!Options::mute)
+	if (!Options::mute && !Options::lazyLoadResources)
 	{
 		for (std::vector< std::pair<std::string, ExtraSounds *> >::const_iterator i = _extraSounds.begin(); i != _extraSounds.end(); ++i)
 		{
@@ -18,10 +18,13 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <map>
+#include <set>
+#include <list>
 #include <vector>
 #include <string>
 #include <bitset>
 #include <type_traits>
+#include <exception>
 #include <SDL.h>
 #include <yaml-cpp/yaml.h>
 #include "../Engine/Options.h"
@@ -97,6 +100,7 @@ class RuleMusic;
 class RuleArcScript;
 class RuleEventScript;
 class RuleEvent;
+class ModRulesetCache;
 class RuleMissionScript;
 class ModScript;
 class ModScriptGlobal;
@@ -149,7 +153,10 @@ private:
 	std::map<std::string, Font*> _fonts;
 	std::map<std::string, Surface*> _surfaces;
 	std::map<std::string, SurfaceSet*> _sets;
-	std::map<std::string, SoundSet*> _sounds;
+	mutable std::map<std::string, SoundSet*> _sounds;
+	mutable std::set<std::string> _loadedSoundSets;
+	std::list<std::pair<std::string, size_t> > _transientSurfaces;
+	size_t _transientSurfacesSize;
 	std::map<std::string, Music*> _musics;
 	std::vector<Uint16> _voxelData;
 	std::vector<std::vector<Uint8> > _transparencyLUTs;
@@ -304,8 +311,19 @@ private:
 	/// Loads a ruleset from a YAML file that have basic resources configuration.
 	void loadResourceConfigFile(const FileMap::FileRecord &filerec);
 	void loadConstants(const YAML::Node &node);
+	/**
+	 * Ruleset file parsed before its rules are loaded.
+	 */
+	struct RulesetDocument
+	{
+		const FileMap::FileRecord *file = nullptr;
+		YAML::Node doc;
+		std::exception_ptr error;
+	};
+	/// Parses all ruleset files of all mods.
+	static std::vector<std::vector<RulesetDocument>> parseRulesetFiles(const FileMap::RSOrder &mods, ModRulesetCache *cache);
 	/// Loads a ruleset from a YAML file.
-	void loadFile(const FileMap::FileRecord &filerec, ModScript &parsers);
+	void loadFile(const YAML::Node &doc, ModScript &parsers);
 	/// Loads a ruleset element.
 	template <typename T>
 	T *loadRule(const YAML::Node &node, std::map<std::string, T*> *map, std::vector<std::string> *index = 0, const std::string &key = "type") const;
@@ -323,13 +341,17 @@ private:
 	/// Creates a transparency lookup table for a given palette.
 	void createTransparencyLUT(Palette *pal);
 	/// Loads a specified mod content.
-	void loadMod(const std::vector<FileMap::FileRecord> &rulesetFiles, ModScript &parsers);
+	void loadMod(const std::vector<RulesetDocument> &rulesetFiles, ModScript &parsers);
 	/// Loads resources from vanilla.
 	void loadVanillaResources();
 	/// Loads resources from extra rulesets.
 	void loadExtraResources();
 	/// Loads surfaces on demand.
 	void lazyLoadSurface(const std::string &name, int width = Screen::ORIGINAL_WIDTH, int height = Screen::ORIGINAL_HEIGHT);
+	/// Loads sound sets on demand.
+	void lazyLoadSoundSet(const std::string &name) const;
+	/// Frees transient surfaces until they fit in the memory budget.
+	void trimTransientSurfaces();
 	/// Loads an external sprite.
 	void loadExtraSprite(ExtraSprites *spritePack, int width = Screen::ORIGINAL_WIDTH, int height = Screen::ORIGINAL_HEIGHT);
 	/// Applies mods to vanilla resources.
@@ -403,6 +425,8 @@ public:
 	Font *getFont(const std::string &name, bool error = true, int scaleX=1, int scaleY=1) const;
 	/// Gets a particular surface.
 	Surface *getSurface(const std::string &name, bool error = true, int width = Screen::ORIGINAL_WIDTH, int height = Screen::ORIGINAL_HEIGHT);
+	/// Gets a particular surface that can be freed again later.
+	Surface *getSurfaceTransient(const std::string &name, bool error = true);
 	/// Gets a particular surface set.
 	SurfaceSet *getSurfaceSet(const std::string &name, bool error = true);
 	SurfaceSet* getSurfaceSet32(const std::string& name, bool error = true, int width = 32 * Options::pediaBgResolutionX / Screen::ORIGINAL_WIDTH,
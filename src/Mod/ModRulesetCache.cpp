@@ -0,0 +1,197 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ModRulesetCache.h"
+#include <iterator>
+#include <vector>
+#include "../Engine/CrossPlatform.h"
+#include "../Engine/FileMap.h"
+#include "../Engine/Logger.h"
+#include "../Engine/YamlBinary.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+const char CacheMagic[] = { 'O', 'X', 'R', 'C' };
+/// Need to be changed every time format of nodes change.
+const size_t CacheVersion = 1;
+
+} // namespace
+
+/**
+ * Creates empty cache for given list of mods.
+ * @param fileName Where cache is stored.
+ * @param modsKey Hash of loaded mods, cache created for other mods is discarded.
+ */
+ModRulesetCache::ModRulesetCache(const std::string &fileName, Uint64 modsKey) : _fileName(fileName), _modsKey(modsKey), _hits(0), _misses(0)
+{
+
+}
+
+/**
+ * Loads cache from disk, if it was created for same mods and same version of cache format.
+ */
+void ModRulesetCache::load()
+{
+	_entries.clear();
+	if (!CrossPlatform::fileExists(_fileName))
+	{
+		return;
+	}
+
+	auto stream = CrossPlatform::readFile(_fileName);
+	if (!stream)
+	{
+		return;
+	}
+	const std::string data((std::istreambuf_iterator<char>(*stream)), std::istreambuf_iterator<char>());
+
+	YamlBinaryReader reader(data.data(), data.data() + data.size());
+	if (!reader.readMagic(CacheMagic, sizeof(CacheMagic)) || reader.readSize() != CacheVersion || reader.readUint64() != _modsKey)
+	{
+		Log(LOG_INFO) << "Ruleset cache is outdated, it will be rebuilt.";
+		return;
+	}
+
+	for (size_t i = reader.readSize(); reader.isValid() && i > 0; --i)
+	{
+		std::string path = reader.readString();
+		Entry e;
+		e.hash = reader.readUint64();
+		e.data = reader.readString();
+		e.used = false;
+		_entries[path] = std::move(e);
+	}
+
+	if (!reader.isValid() || !reader.isEnd())
+	{
+		Log(LOG_WARNING) << "Ruleset cache is corrupted, it will be rebuilt.";
+		_entries.clear();
+	}
+}
+
+/**
+ * Saves all files used since loading, if any of them was not taken from cache.
+ */
+void ModRulesetCache::save() const
+{
+	Log(LOG_INFO) << "Ruleset cache: " << _hits << " files loaded from cache, " << _misses << " files parsed.";
+
+	bool changed = _misses > 0;
+	size_t count = 0;
+	for (const auto &p : _entries)
+	{
+		if (p.second.used)
+		{
+			++count;
+		}
+		else
+		{
+			changed = true;
+		}
+	}
+	if (!changed)
+	{
+		return;
+	}
+
+	YamlBinaryWriter out;
+	out.writeBytes(CacheMagic, sizeof(CacheMagic));
+	out.writeSize(CacheVersion);
+	out.writeUint64(_modsKey);
+	out.writeSize(count);
+	for (const auto &p : _entries)
+	{
+		if (p.second.used)
+		{
+			out.writeString(p.first);
+			out.writeUint64(p.second.hash);
+			out.writeString(p.second.data);
+		}
+	}
+
+	CrossPlatform::writeFile(_fileName, std::vector<unsigned char>(out.getData().begin(), out.getData().end()));
+}
+
+/**
+ * Gets parsed ruleset file. If content of file did not change from when it was stored
+ * in cache, YAML parsing is skipped and nodes are recreated from binary data.
+ * Called from worker threads, so errors are only thrown and caller logs them.
+ * @param filerec File to load.
+ * @return Root node of file.
+ */
+YAML::Node ModRulesetCache::getYAML(const FileMap::FileRecord &filerec)
+{
+	auto stream = filerec.readIStream();
+	const std::string text((std::istreambuf_iterator<char>(*stream)), std::istreambuf_iterator<char>());
+	const Uint64 textHash = hash(text);
+
+	// references to elements stay valid when other threads add new ones
+	Entry *entry;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		entry = &_entries[filerec.fullpath];
+	}
+
+	if (entry->hash == textHash && !entry->data.empty())
+	{
+		YamlBinaryReader reader(entry->data.data(), entry->data.data() + entry->data.size());
+		YAML::Node doc = reader.readNode();
+		if (reader.isValid() && reader.isEnd())
+		{
+			entry->used = true;
+			std::lock_guard<std::mutex> lock(_mutex);
+			++_hits;
+			return doc;
+		}
+	}
+
+	YAML::Node doc = YAML::Load(text);
+
+	entry->hash = textHash;
+	YamlBinaryWriter writer;
+	writer.writeNode(doc);
+	entry->data = std::move(writer.getData());
+	entry->used = true;
+	std::lock_guard<std::mutex> lock(_mutex);
+	++_misses;
+	return doc;
+}
+
+/**
+ * Calculates FNV-1a hash of data.
+ * @param data Data to hash.
+ * @param size Size of data.
+ * @param seed Initial value or result of previous call.
+ * @return Hash.
+ */
+Uint64 ModRulesetCache::hash(const void *data, size_t size, Uint64 seed)
+{
+	const Uint8 *bytes = (const Uint8 *)data;
+	for (size_t i = 0; i < size; ++i)
+	{
+		seed ^= bytes[i];
+		seed *= 1099511628211ULL;
+	}
+	return seed;
+}
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include <yaml-cpp/yaml.h>
+#include <SDL_types.h>
+
+namespace OpenXcom
+{
+
+namespace FileMap
+{
+	struct FileRecord;
+}
+
+/**
+ * Binary cache of parsed ruleset files, kept in user folder between runs.
+ * Every file is stored with hash of its content, only files that did not change
+ * are taken from cache, others are parsed again from YAML.
+ * Different files can be loaded from different threads at the same time.
+ */
+class ModRulesetCache
+{
+	struct Entry
+	{
+		Uint64 hash;
+		std::string data;
+		bool used;
+	};
+
+	std::string _fileName;
+	Uint64 _modsKey;
+	std::unordered_map<std::string, Entry> _entries;
+	std::mutex _mutex;
+	size_t _hits, _misses;
+
+public:
+	/// Creates empty cache for given list of mods.
+	ModRulesetCache(const std::string &fileName, Uint64 modsKey);
+
+	/// Loads cache from disk, if it was created for same mods.
+	void load();
+	/// Saves all files used since loading.
+	void save() const;
+	/// Gets parsed ruleset file, from cache if possible.
+	YAML::Node getYAML(const FileMap::FileRecord &filerec);
+
+	/// Calculates hash of data, can be chained using previous result as seed.
+	static Uint64 hash(const void *data, size_t size, Uint64 seed = 14695981039346656037ULL);
+	/// Calculates hash of string.
+	static Uint64 hash(const std::string &str, Uint64 seed = 14695981039346656037ULL) { return hash(str.data(), str.size(), seed); }
+};
+
+}
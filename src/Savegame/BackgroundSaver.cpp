@@ -0,0 +1,167 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BackgroundSaver.h"
+#include "../Engine/CrossPlatform.h"
+#include "../Engine/Exception.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Creates the saver, the thread is started by first save.
+ */
+BackgroundSaver::BackgroundSaver() : _busy(false), _quit(false)
+{
+}
+
+/**
+ * Waits for the last save and stops the thread.
+ */
+BackgroundSaver::~BackgroundSaver()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_quit = true;
+	}
+	_cond.notify_all();
+	if (_thread.joinable())
+	{
+		_thread.join();
+	}
+}
+
+/**
+ * Gets the saver shared by the whole game.
+ * @return Background saver.
+ */
+BackgroundSaver &BackgroundSaver::getInstance()
+{
+	static BackgroundSaver instance;
+	return instance;
+}
+
+/**
+ * Checks if a save is still being written.
+ * @return True if the thread is busy.
+ */
+bool BackgroundSaver::isBusy()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _busy;
+}
+
+/**
+ * Starts writing a save, waiting for the previous one first if needed.
+ * The file is written with .bak extension and renamed when complete,
+ * so a crash never leaves a half written save behind.
+ * @param folder Folder of the save.
+ * @param filename Save filename.
+ * @param data Save data prepared by SaveFormat::snapshot().
+ */
+void BackgroundSaver::save(const std::string &folder, const std::string &filename, SaveFormat::Snapshot &&data)
+{
+	wait();
+	std::unique_lock<std::mutex> lock(_mutex);
+	_job.reset(new Job{ folder, filename, std::move(data) });
+	_busy = true;
+	if (!_thread.joinable())
+	{
+		_thread = std::thread(&BackgroundSaver::run, this);
+	}
+	lock.unlock();
+	_cond.notify_all();
+}
+
+/**
+ * Waits until the last save is written.
+ */
+void BackgroundSaver::wait()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_cond.wait(lock, [this]{ return !_busy; });
+}
+
+/**
+ * Gets the error of the last failed save and clears it.
+ * @return Error message, empty if there was no error.
+ */
+std::string BackgroundSaver::takeError()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	std::string error;
+	error.swap(_error);
+	return error;
+}
+
+/**
+ * Writes saves until asked to quit. A pending save is always finished first.
+ * Nothing here may log, errors are kept for the main thread to report.
+ */
+void BackgroundSaver::run()
+{
+	while (true)
+	{
+		std::unique_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_cond.wait(lock, [this]{ return _job || _quit; });
+			if (!_job)
+			{
+				return;
+			}
+			job = std::move(_job);
+		}
+
+		std::string error;
+		try
+		{
+			std::string fullPath = job->folder + job->filename;
+			std::string bakPath = fullPath + ".bak";
+			SaveFormat::write(bakPath, job->data);
+			if (!CrossPlatform::moveFile(bakPath, fullPath))
+			{
+				throw Exception("Failed to rename " + job->filename + ".bak to " + job->filename + ", the save was left in " + job->filename + ".bak");
+			}
+		}
+		catch (Exception &e)
+		{
+			error = e.what();
+		}
+		catch (YAML::Exception &e)
+		{
+			error = e.what();
+		}
+		catch (std::exception &e)
+		{
+			error = e.what();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (!error.empty())
+			{
+				_error = error;
+			}
+			_busy = false;
+		}
+		_cond.notify_all();
+	}
+}
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include "SaveFormat.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Writes prepared saves from a background thread, one at a time.
+ * The thread only works on a snapshot of the save data, never on the game itself.
+ */
+class BackgroundSaver
+{
+private:
+	struct Job
+	{
+		std::string folder, filename;
+		SaveFormat::Snapshot data;
+	};
+
+	std::thread _thread;
+	std::mutex _mutex;
+	std::condition_variable _cond;
+	std::unique_ptr<Job> _job;
+	bool _busy, _quit;
+	std::string _error;
+
+	/// Writes saves until asked to quit.
+	void run();
+public:
+	/// Creates the saver, the thread is started by first save.
+	BackgroundSaver();
+	/// Waits for the last save and stops the thread.
+	~BackgroundSaver();
+	/// Gets the shared saver.
+	static BackgroundSaver &getInstance();
+	/// Is a save still being written?
+	bool isBusy();
+	/// Starts writing a save.
+	void save(const std::string &folder, const std::string &filename, SaveFormat::Snapshot &&data);
+	/// Waits until the last save is written.
+	void wait();
+	/// Gets the error of the last failed save and clears it.
+	std::string takeError();
+};
+
+}
@@ -2980,6 +2980,8 @@ void BattleUnit::setTile(Tile *tile, SavedBattleGame *saveBattleGame)
 		return;
 	}
 
+	saveBattleGame->updateMapVersion();
+
 	auto armorSize = _armor->getSize() - 1;
 	// Reset tiles moved from.
 	if (_tile)
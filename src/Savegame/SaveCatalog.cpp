@@ -0,0 +1,242 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SaveCatalog.h"
+#include <memory>
+#include "../Engine/CrossPlatform.h"
+#include "../Engine/Exception.h"
+#include "../Engine/Logger.h"
+#include "../Engine/Options.h"
+
+namespace OpenXcom
+{
+
+const std::string SaveCatalog::INDEX_FILENAME = "saves.idx";
+
+namespace
+{
+
+const int CATALOG_VERSION = 2;
+
+std::mutex instanceMutex;
+std::unique_ptr<SaveCatalog> instance;
+
+}
+
+/**
+ * Creates an empty catalog of a folder.
+ * @param folder Full path to the folder with saves.
+ */
+SaveCatalog::SaveCatalog(const std::string &folder) : _folder(folder), _modified(false)
+{
+}
+
+/**
+ * Gets the catalog of the current master user folder,
+ * loading its index when the folder is used for the first time.
+ * @return Catalog of saves.
+ */
+SaveCatalog &SaveCatalog::getInstance()
+{
+	std::lock_guard<std::mutex> lock(instanceMutex);
+	std::string folder = Options::getMasterUserFolder();
+	if (!instance || instance->_folder != folder)
+	{
+		instance.reset(new SaveCatalog(folder));
+		instance->load();
+	}
+	return *instance;
+}
+
+/**
+ * Loads the index from the folder. A missing or broken index
+ * is not an error, all saves are simply read again.
+ */
+void SaveCatalog::load()
+{
+	std::string path = _folder + INDEX_FILENAME;
+	if (!CrossPlatform::fileExists(path))
+	{
+		return;
+	}
+	try
+	{
+		YAML::Node doc = YAML::Load(*CrossPlatform::readFile(path));
+		if (doc["version"].as<int>(0) != CATALOG_VERSION)
+		{
+			return;
+		}
+		for (const YAML::Node &i : doc["saves"])
+		{
+			Entry &e = _entries[i["file"].as<std::string>()];
+			e.timestamp = (time_t)i["timestamp"].as<int64_t>();
+			e.size = i["size"].as<Uint64>();
+			e.header = i["header"];
+		}
+		Log(LOG_VERBOSE) << "Save catalog: " << _entries.size() << " entries loaded from " << path;
+	}
+	catch (YAML::Exception &e)
+	{
+		Log(LOG_WARNING) << "Ignoring broken save catalog " << path << ": " << e.what();
+		_entries.clear();
+	}
+	catch (Exception &e)
+	{
+		Log(LOG_WARNING) << "Ignoring broken save catalog " << path << ": " << e.what();
+		_entries.clear();
+	}
+}
+
+/**
+ * Saves the index to the folder if any entry changed since it was loaded.
+ */
+void SaveCatalog::save()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (!_modified)
+	{
+		return;
+	}
+	YAML::Emitter out;
+	YAML::Node doc;
+	doc["version"] = CATALOG_VERSION;
+	for (const auto &i : _entries)
+	{
+		YAML::Node node;
+		node["file"] = i.first;
+		node["timestamp"] = (int64_t)i.second.timestamp;
+		node["size"] = i.second.size;
+		node["header"] = i.second.header;
+		doc["saves"].push_back(node);
+	}
+	out << doc;
+	std::string path = _folder + INDEX_FILENAME;
+	if (CrossPlatform::writeFile(path, out.c_str()))
+	{
+		_modified = false;
+	}
+	else
+	{
+		Log(LOG_WARNING) << "Failed to write save catalog " << path;
+	}
+}
+
+/**
+ * Reads and parses the header of a save file.
+ * @param file Save filename.
+ * @return Brief game info of the save.
+ */
+YAML::Node SaveCatalog::readHeader(const std::string &file) const
+{
+	return YAML::Load(*CrossPlatform::getYamlSaveHeader(_folder + file));
+}
+
+/**
+ * Gets the header of a save file. The file is only read
+ * if it is not in the catalog or was modified since.
+ * Modification time has only one second resolution,
+ * so size of the file is compared too.
+ * @param file Save filename.
+ * @param timestamp Modification time of the file.
+ * @return Brief game info of the save.
+ */
+YAML::Node SaveCatalog::getHeader(const std::string &file, time_t timestamp)
+{
+	const Uint64 size = CrossPlatform::getFileSize(_folder + file);
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto i = _entries.find(file);
+		if (i != _entries.end() && i->second.timestamp == timestamp && i->second.size == size)
+		{
+			return i->second.header;
+		}
+	}
+	YAML::Node header = readHeader(file);
+	std::lock_guard<std::mutex> lock(_mutex);
+	_entries[file] = Entry{ timestamp, size, header };
+	_modified = true;
+	return header;
+}
+
+/**
+ * Rereads the header of a save that was just written and saves the index.
+ * The header is always read, the save could be overwritten within the same second.
+ * @param file Save filename.
+ */
+void SaveCatalog::update(const std::string &file)
+{
+	try
+	{
+		const std::string path = _folder + file;
+		const time_t timestamp = CrossPlatform::getDateModified(path);
+		const Uint64 size = CrossPlatform::getFileSize(path);
+		YAML::Node header = readHeader(file);
+		std::lock_guard<std::mutex> lock(_mutex);
+		_entries[file] = Entry{ timestamp, size, header };
+		_modified = true;
+	}
+	catch (YAML::Exception &e)
+	{
+		Log(LOG_ERROR) << file << ": " << e.what();
+		remove(file);
+	}
+	catch (Exception &e)
+	{
+		Log(LOG_ERROR) << file << ": " << e.what();
+		remove(file);
+	}
+	save();
+}
+
+/**
+ * Removes a save from the catalog, e.g. after it was deleted.
+ * @param file Save filename.
+ */
+void SaveCatalog::remove(const std::string &file)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_entries.erase(file))
+	{
+		_modified = true;
+	}
+}
+
+/**
+ * Removes all saves that are not in the list, e.g. ones deleted outside the game.
+ * @param files Filenames of all saves in the folder.
+ */
+void SaveCatalog::retain(const std::vector<std::string> &files)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	std::map<std::string, Entry> entries;
+	for (const auto &file : files)
+	{
+		auto i = _entries.find(file);
+		if (i != _entries.end())
+		{
+			entries.insert(*i);
+		}
+	}
+	if (entries.size() != _entries.size())
+	{
+		_entries.swap(entries);
+		_modified = true;
+	}
+}
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <ctime>
+#include <yaml-cpp/yaml.h>
+#include <SDL_types.h>
+
+namespace OpenXcom
+{
+
+/**
+ * Index of the headers of all saves in the user folder,
+ * so the save lists only need to read files that changed since they were last seen.
+ * Stored next to the saves and kept up to date when saves are written or deleted.
+ */
+class SaveCatalog
+{
+private:
+	struct Entry
+	{
+		time_t timestamp;
+		Uint64 size;
+		YAML::Node header;
+	};
+	static const std::string INDEX_FILENAME;
+
+	std::string _folder;
+	std::map<std::string, Entry> _entries;
+	bool _modified;
+	std::mutex _mutex;
+
+	/// Creates an empty catalog of a folder.
+	SaveCatalog(const std::string &folder);
+	/// Loads the index from the folder.
+	void load();
+	/// Reads the header of a save file.
+	YAML::Node readHeader(const std::string &file) const;
+public:
+	/// Gets the catalog of the current user folder.
+	static SaveCatalog &getInstance();
+	/// Gets the header of a save file, reading it if its time or size changed.
+	YAML::Node getHeader(const std::string &file, time_t timestamp);
+	/// Rereads the header of a save that was just written.
+	void update(const std::string &file);
+	/// Removes a save from the catalog.
+	void remove(const std::string &file);
+	/// Removes all saves not in the list from the catalog.
+	void retain(const std::vector<std::string> &files);
+	/// Saves the index to the folder if it changed.
+	void save();
+};
+
+}
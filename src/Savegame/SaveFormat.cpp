@@ -0,0 +1,291 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SaveFormat.h"
+#include <iterator>
+#include <memory>
+#include <SDL_rwops.h>
+#include "../../libs/miniz/miniz.h"
+#include "../Engine/CrossPlatform.h"
+#include "../Engine/Exception.h"
+#include "../Engine/Logger.h"
+#include "../Engine/YamlBinary.h"
+
+namespace OpenXcom
+{
+
+namespace SaveFormat
+{
+
+namespace
+{
+
+const char BinaryMagic[] = { 'O', 'X', 'S', 'B' };
+/// Need to be changed every time format of binary data change.
+const size_t BinaryVersion = 1;
+/// Separator between brief info and full game data.
+const std::string DocSeparator = "\n---\n";
+/// How much data is buffered before it is compressed and written.
+const size_t StreamChunkSize = 64 * 1024;
+
+/**
+ * Passes compressed data to file.
+ */
+mz_bool putCompressed(const void *buf, int len, void *user)
+{
+	return SDL_RWwrite((SDL_RWops*)user, buf, len, 1) == 1;
+}
+
+/**
+ * Writes binary save, full game data is compressed as it is written.
+ */
+bool writeBinary(SDL_RWops *rwops, const YAML::Node &brief, const std::function<void(YamlBinaryWriter&)> &writeData)
+{
+	YAML::Emitter out;
+	out << brief;
+	std::string header = out.c_str() + DocSeparator;
+	header.append(BinaryMagic, sizeof(BinaryMagic));
+	if (SDL_RWwrite(rwops, header.data(), header.size(), 1) != 1)
+	{
+		return false;
+	}
+
+	// compressor state is too big for stack
+	std::unique_ptr<tdefl_compressor> comp(new tdefl_compressor);
+	if (tdefl_init(comp.get(), putCompressed, rwops, tdefl_create_comp_flags_from_zip_params(MZ_BEST_SPEED, 15, MZ_DEFAULT_STRATEGY)) != TDEFL_STATUS_OKAY)
+	{
+		return false;
+	}
+	bool valid = true;
+	YamlBinaryWriter writer([&](const char *data, size_t size)
+	{
+		valid = valid && tdefl_compress_buffer(comp.get(), data, size, TDEFL_NO_FLUSH) == TDEFL_STATUS_OKAY;
+	}, StreamChunkSize);
+	writeData(writer);
+	writer.flush();
+	return valid && tdefl_compress_buffer(comp.get(), nullptr, 0, TDEFL_FINISH) == TDEFL_STATUS_DONE;
+}
+
+/**
+ * Reads full game data of binary save.
+ */
+YAML::Node readBinary(const char *begin, const char *end, const std::string &filename)
+{
+	size_t size = 0;
+	void *data = tinfl_decompress_mem_to_heap(begin, end - begin, &size, TINFL_FLAG_PARSE_ZLIB_HEADER);
+	if (!data)
+	{
+		throw Exception("Failed to decompress " + filename);
+	}
+	YamlBinaryReader reader((const char*)data, (const char*)data + size);
+	YAML::Node doc;
+	if (reader.readSize() == BinaryVersion)
+	{
+		doc = reader.readNode();
+	}
+	bool valid = reader.isValid() && reader.isEnd();
+	mz_free(data);
+	if (!valid)
+	{
+		throw Exception("Invalid binary data in " + filename);
+	}
+	return doc;
+}
+
+/**
+ * Writes YAML text save.
+ * Errors are only thrown, never logged, as this can run outside the main thread.
+ */
+void writeText(const std::string &filename, const YAML::Node &brief, const YAML::Node &doc)
+{
+	YAML::Emitter out;
+	out << brief;
+	out << YAML::BeginDoc;
+	out << doc;
+	// Even SDL1 file IO accepts UTF-8 file names on windows.
+	SDL_RWops *rwops = SDL_RWFromFile(filename.c_str(), "w");
+	if (!rwops)
+	{
+		throw Exception("Failed to save " + filename + ": could not open file");
+	}
+	bool written = SDL_RWwrite(rwops, out.c_str(), out.size(), 1) == 1;
+	SDL_RWclose(rwops);
+	if (!written)
+	{
+		throw Exception("Failed to save " + filename + ": could not write file");
+	}
+}
+
+/**
+ * Opens file and writes binary save.
+ * Errors are only thrown, never logged, as this can run outside the main thread.
+ */
+void writeBinaryFile(const std::string &filename, const YAML::Node &brief, const std::function<void(YamlBinaryWriter&)> &writeData)
+{
+	// Even SDL1 file IO accepts UTF-8 file names on windows.
+	SDL_RWops *rwops = SDL_RWFromFile(filename.c_str(), "wb");
+	if (!rwops)
+	{
+		throw Exception("Failed to save " + filename + ": could not open file");
+	}
+	bool written = writeBinary(rwops, brief, writeData);
+	SDL_RWclose(rwops);
+	if (!written)
+	{
+		throw Exception("Failed to save " + filename + ": could not write file");
+	}
+}
+
+}
+
+/**
+ * Reads the brief info and full game data of a save, in any format.
+ * @param filename Full path of save file.
+ * @param binary Optionally returns if save was in binary format.
+ * @return List of documents in the save.
+ */
+std::vector<YAML::Node> read(const std::string &filename, bool *binary)
+{
+	auto stream = CrossPlatform::readFile(filename);
+	const std::string data((std::istreambuf_iterator<char>(*stream)), std::istreambuf_iterator<char>());
+
+	size_t sep = data.find(DocSeparator);
+	bool isBinary = sep != std::string::npos && data.compare(sep + DocSeparator.size(), sizeof(BinaryMagic), BinaryMagic, sizeof(BinaryMagic)) == 0;
+	if (binary)
+	{
+		*binary = isBinary;
+	}
+	if (!isBinary)
+	{
+		return YAML::LoadAll(data);
+	}
+
+	std::vector<YAML::Node> docs;
+	docs.push_back(YAML::Load(data.substr(0, sep + 1)));
+	const char *begin = data.data() + sep + DocSeparator.size() + sizeof(BinaryMagic);
+	docs.push_back(readBinary(begin, data.data() + data.size(), filename));
+	return docs;
+}
+
+/**
+ * Writes the brief info and full game data to a save.
+ * @param filename Full path of save file.
+ * @param brief Brief game info used in save lists.
+ * @param doc Full game data.
+ * @param binary Use compressed binary format instead of YAML text.
+ */
+void write(const std::string &filename, const YAML::Node &brief, const YAML::Node &doc, bool binary)
+{
+	if (!binary)
+	{
+		writeText(filename, brief, doc);
+		return;
+	}
+	writeBinaryFile(filename, brief, [&](YamlBinaryWriter &writer)
+	{
+		writer.writeSize(BinaryVersion);
+		writer.writeNode(doc);
+	});
+}
+
+/**
+ * Prepares save data to be written later, possibly by another thread.
+ * Binary data is serialized right away, leaving only compression and writing,
+ * for YAML text emitting the nodes is the slow part, so they are passed as they are.
+ * @note Nodes must not be shared with anything else, like the ones built by SavedGame.
+ * @param brief Brief game info used in save lists.
+ * @param doc Full game data.
+ * @param binary Use compressed binary format instead of YAML text.
+ * @return Data independent of the game state.
+ */
+Snapshot snapshot(const YAML::Node &brief, const YAML::Node &doc, bool binary)
+{
+	Snapshot snap;
+	snap.brief = brief;
+	snap.isBinary = binary;
+	if (binary)
+	{
+		YamlBinaryWriter writer;
+		writer.writeSize(BinaryVersion);
+		writer.writeNode(doc);
+		snap.binary = std::move(writer.getData());
+	}
+	else
+	{
+		snap.doc = doc;
+	}
+	return snap;
+}
+
+/**
+ * Writes prepared save data to a save.
+ * @param filename Full path of save file.
+ * @param snap Data prepared by snapshot().
+ */
+void write(const std::string &filename, const Snapshot &snap)
+{
+	if (!snap.isBinary)
+	{
+		writeText(filename, snap.brief, snap.doc);
+		return;
+	}
+	writeBinaryFile(filename, snap.brief, [&](YamlBinaryWriter &writer)
+	{
+		writer.writeBytes(snap.binary.data(), snap.binary.size());
+	});
+}
+
+/**
+ * Converts a save between YAML text and binary format.
+ * The original file is kept with .bak extension.
+ * @param filename Full path of save file.
+ * @return Was the save converted?
+ */
+bool convert(const std::string &filename)
+{
+	try
+	{
+		bool binary = false;
+		std::vector<YAML::Node> docs = read(filename, &binary);
+		if (docs.size() != 2)
+		{
+			throw Exception("Unexpected number of documents in " + filename);
+		}
+		std::string backup = filename + ".bak";
+		if (!CrossPlatform::moveFile(filename, backup))
+		{
+			throw Exception("Failed to back up " + filename);
+		}
+		write(filename, docs[0], docs[1], !binary);
+		Log(LOG_INFO) << "Converted " << filename << " to " << (binary ? "YAML" : "binary") << " format, original kept in " << backup;
+		return true;
+	}
+	catch (Exception &e)
+	{
+		Log(LOG_ERROR) << e.what();
+	}
+	catch (YAML::Exception &e)
+	{
+		Log(LOG_ERROR) << filename << ": " << e.what();
+	}
+	return false;
+}
+
+}
+
+}
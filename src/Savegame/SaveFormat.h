@@ -0,0 +1,58 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+namespace OpenXcom
+{
+
+/**
+ * Reading and writing of save files, either as YAML text or in compact binary format.
+ * Both start with the brief game info as YAML text, so save lists can read either.
+ * In binary saves it is followed by compressed binary nodes of the full game data.
+ */
+namespace SaveFormat
+{
+	/**
+	 * Save data not referenced by the game any more,
+	 * so it can be written by another thread.
+	 */
+	struct Snapshot
+	{
+		YAML::Node brief;
+		YAML::Node doc;
+		std::string binary;
+		bool isBinary = false;
+	};
+
+	/// Reads the brief info and full game data of a save.
+	std::vector<YAML::Node> read(const std::string &filename, bool *binary = nullptr);
+	/// Writes the brief info and full game data to a save.
+	void write(const std::string &filename, const YAML::Node &brief, const YAML::Node &doc, bool binary);
+	/// Prepares save data to be written later.
+	Snapshot snapshot(const YAML::Node &brief, const YAML::Node &doc, bool binary);
+	/// Writes prepared save data to a save.
+	void write(const std::string &filename, const Snapshot &snapshot);
+	/// Converts a save to the other format.
+	bool convert(const std::string &filename);
+}
+
+}
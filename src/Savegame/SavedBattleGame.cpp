@@ -670,9 +670,13 @@ void SavedBattleGame::initMap(int mapsize_x, int mapsize_y, int mapsize_z, bool
 
 	_tiles.clear();
 	_tiles.reserve(_mapsize_z * _mapsize_y * _mapsize_x);
+	_tileVoxels.clear();
+	_tileVoxels.resize(_mapsize_z * _mapsize_y * _mapsize_x);
+	_tileHot.reset(_mapsize_z * _mapsize_y * _mapsize_x);
 	for (int i = 0; i < _mapsize_z * _mapsize_y * _mapsize_x; ++i)
 	{
-		_tiles.push_back(Tile(getTileCoords(i)));
+		_tiles.push_back(Tile(getTileCoords(i), &_tileHot, i));
+		_tiles.back().setVoxelCache(&_tileVoxels[i]);
 	}
 
 }
@@ -2138,6 +2142,9 @@ void SavedBattleGame::prepareNewTurn()
 		(*i)->calculateEnviDamage(mod, this);
 	}
 
+	// fire and smoke changed, and some terrain could burn out.
+	updateMapVersion();
+
 	//fov and light udadates are done in `BattlescapeGame::endTurn`
 }
 
@@ -64,6 +64,9 @@ private:
 	int _mapsize_x, _mapsize_y, _mapsize_z;
 	std::vector<MapDataSet*> _mapDataSets;
 	std::vector<Tile> _tiles;
+	std::vector<TileVoxelCache> _tileVoxels;
+	TileHotData _tileHot;
+	Uint32 _mapVersion = 0;
 	BattleUnit *_selectedUnit, *_lastSelectedUnit;
 	std::vector<Node*> _nodes;
 	std::vector<BattleUnit*> _units;
@@ -256,6 +259,30 @@ public:
 		return &_tiles[i];
 	}
 
+	/**
+	 * Gets compact voxel data of tile, kept in sync by Tile::setMapData.
+	 * @param i Index position, less than `getMapSizeXYZ()`.
+	 * @return Voxel data of tile at that index.
+	 */
+	const TileVoxelCache& getTileVoxels(int i) const
+	{
+		return _tileVoxels[i];
+	}
+
+	/**
+	 * Gets frequently used data of all tiles, stored as parallel arrays indexed by tile index.
+	 * @return Data shared by all tiles.
+	 */
+	TileHotData& getTileHotData()
+	{
+		return _tileHot;
+	}
+
+	/// Marks that units, doors or terrain changed, invalidates cached reachable tiles.
+	void updateMapVersion() { ++_mapVersion; }
+	/// Gets counter of map changes that affect unit movement.
+	Uint32 getMapVersion() const { return _mapVersion; }
+
 	/**
 	 * Get tile that is below current one (const version).
 	 * @param tile
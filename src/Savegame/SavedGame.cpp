@@ -33,6 +33,9 @@
 #include "../Engine/CrossPlatform.h"
 #include "../Engine/ScriptBind.h"
 #include "SavedBattleGame.h"
+#include "SaveCatalog.h"
+#include "BackgroundSaver.h"
+#include "SaveFormat.h"
 #include "SerializationHelper.h"
 #include "GameTime.h"
 #include "Country.h"
@@ -285,20 +288,31 @@ static bool _isCurrentGameType(const SaveInfo &saveInfo, const std::string &curM
 std::vector<SaveInfo> SavedGame::getList(Language *lang, bool autoquick)
 {
 	std::vector<SaveInfo> info;
+	std::vector<std::string> allSaves;
 	std::string curMaster = Options::getActiveMaster();
 	auto saves = CrossPlatform::getFolderContents(Options::getMasterUserFolder(), "sav");
+	auto asaves = CrossPlatform::getFolderContents(Options::getMasterUserFolder(), "asav");
+	for (auto i = asaves.begin(); i != asaves.end(); ++i)
+	{
+		allSaves.push_back(std::get<0>(*i));
+	}
+	for (auto i = saves.begin(); i != saves.end(); ++i)
+	{
+		allSaves.push_back(std::get<0>(*i));
+	}
 
 	if (autoquick)
 	{
-		auto asaves = CrossPlatform::getFolderContents(Options::getMasterUserFolder(), "asav");
 		saves.insert(saves.begin(), asaves.begin(), asaves.end());
 	}
+	SaveCatalog &catalog = SaveCatalog::getInstance();
+	catalog.retain(allSaves);
 	for (auto i = saves.begin(); i != saves.end(); ++i)
 	{
 		auto filename = std::get<0>(*i);
 		try
 		{
-			SaveInfo saveInfo = getSaveInfo(filename, lang);
+			SaveInfo saveInfo = getSaveInfo(filename, catalog.getHeader(filename, std::get<2>(*i)), std::get<2>(*i), lang);
 			if (!_isCurrentGameType(saveInfo, curMaster))
 			{
 				continue;
@@ -316,6 +330,7 @@ std::vector<SaveInfo> SavedGame::getList(Language *lang, bool autoquick)
 			continue;
 		}
 	}
+	catalog.save();
 
 	return info;
 }
@@ -323,12 +338,12 @@ std::vector<SaveInfo> SavedGame::getList(Language *lang, bool autoquick)
 /**
  * Gets the info of a specific save file.
  * @param file Save filename.
+ * @param doc Brief game info stored in the save.
+ * @param timestamp Modification time of the save.
  * @param lang Loaded language.
  */
-SaveInfo SavedGame::getSaveInfo(const std::string &file, Language *lang)
+SaveInfo SavedGame::getSaveInfo(const std::string &file, const YAML::Node &doc, time_t timestamp, Language *lang)
 {
-	std::string fullname = Options::getMasterUserFolder() + file;
-	YAML::Node doc = YAML::Load(*CrossPlatform::getYamlSaveHeader(fullname));
 	SaveInfo save;
 
 	save.fileName = file;
@@ -371,7 +386,7 @@ SaveInfo SavedGame::getSaveInfo(const std::string &file, Language *lang)
 		save.reserved = false;
 	}
 
-	save.timestamp = CrossPlatform::getDateModified(fullname);
+	save.timestamp = timestamp;
 	std::pair<std::string, std::string> str = CrossPlatform::timeToString(save.timestamp);
 	save.isoDate = str.first;
 	save.isoTime = str.second;
@@ -410,7 +425,7 @@ SaveInfo SavedGame::getSaveInfo(const std::string &file, Language *lang)
 void SavedGame::load(const std::string &filename, Mod *mod, Language *lang)
 {
 	std::string filepath = Options::getMasterUserFolder() + filename;
-	std::vector<YAML::Node> file = YAML::LoadAll(*CrossPlatform::readFile(filepath));
+	std::vector<YAML::Node> file = SaveFormat::read(filepath);
 	// Get brief save info
 	YAML::Node brief = file[0];
 	_time->load(brief["time"]);
@@ -793,13 +808,41 @@ void SavedGame::load(const std::string &filename, Mod *mod, Language *lang)
 /**
  * Saves a saved game's contents to a YAML file.
  * @param filename YAML filename.
+ * @param mod Mod for the saved game.
  */
 void SavedGame::save(const std::string &filename, Mod *mod) const
 {
-	YAML::Emitter out;
+	YAML::Node brief, node;
+	saveNodes(brief, node, mod);
+
+	std::string filepath = Options::getMasterUserFolder() + filename;
+	SaveFormat::write(filepath, brief, node, Options::oxceBinarySaves);
+}
 
+/**
+ * Saves a saved game's contents to a YAML file without waiting for it to be written.
+ * Only a copy of the save data is made here, converting and writing it
+ * is left to a background thread, so the game can go on meanwhile.
+ * @param filename YAML filename.
+ * @param mod Mod for the saved game.
+ */
+void SavedGame::saveInBackground(const std::string &filename, Mod *mod) const
+{
+	YAML::Node brief, node;
+	saveNodes(brief, node, mod);
+
+	BackgroundSaver::getInstance().save(Options::getMasterUserFolder(), filename, SaveFormat::snapshot(brief, node, Options::oxceBinarySaves));
+}
+
+/**
+ * Saves a saved game's contents to YAML nodes.
+ * @param brief Brief game info used in the saves list.
+ * @param node Full game data.
+ * @param mod Mod for the saved game.
+ */
+void SavedGame::saveNodes(YAML::Node &brief, YAML::Node &node, Mod *mod) const
+{
 	// Saves the brief game info used in the saves list
-	YAML::Node brief;
 	brief["name"] = _name;
 	brief["version"] = OPENXCOM_VERSION_SHORT;
 	std::string git_sha = OPENXCOM_VERSION_GIT;
@@ -827,10 +870,7 @@ void SavedGame::save(const std::string &filename, Mod *mod) const
 	brief["mods"] = modsList;
 	if (_ironman)
 		brief["ironman"] = _ironman;
-	out << brief;
 	// Saves the full game data to the save
-	out << YAML::BeginDoc;
-	YAML::Node node;
 	node["difficulty"] = (int)_difficulty;
 	node["end"] = (int)_end;
 	node["monthsPassed"] = _monthsPassed;
@@ -964,15 +1004,6 @@ void SavedGame::save(const std::string &filename, Mod *mod) const
 		node["battleGame"] = _battleGame->save();
 	}
 	_scriptValues.save(node, mod->getScriptGlobal());
-
-	out << node;
-
-
-	std::string filepath = Options::getMasterUserFolder() + filename;
-	if (!CrossPlatform::writeFile(filepath, out.c_str()))
-	{
-		throw Exception("Failed to save " + filepath);
-	}
 }
 
 /**
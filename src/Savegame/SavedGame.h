@@ -175,7 +175,9 @@ private:
 	bool _alienContainmentChecked;
 	ScriptValues<SavedGame> _scriptValues;
 
-	static SaveInfo getSaveInfo(const std::string &file, Language *lang);
+	static SaveInfo getSaveInfo(const std::string &file, const YAML::Node &doc, time_t timestamp, Language *lang);
+	/// Saves the brief info and full game data to YAML nodes.
+	void saveNodes(YAML::Node &brief, YAML::Node &node, Mod *mod) const;
 public:
 	static const std::string AUTOSAVE_GEOSCAPE, AUTOSAVE_BATTLESCAPE, QUICKSAVE;
 	/// Creates a new saved game.
@@ -190,6 +192,8 @@ public:
 	void load(const std::string &filename, Mod *mod, Language *lang);
 	/// Saves a saved game to YAML.
 	void save(const std::string &filename, Mod *mod) const;
+	/// Saves a saved game to YAML from another thread.
+	void saveInBackground(const std::string &filename, Mod *mod) const;
 	/// Gets the game name.
 	std::string getName() const;
 	/// Sets the game name.
@@ -48,11 +48,30 @@ Tile::SerializationKey Tile::serializationKey =
  4 + 2*4 + 2*4 + 1 + 1 + 1 // total bytes to save one tile
 };
 
+/**
+ * Resets all arrays to default values for given number of tiles.
+ * @param size Number of tiles on map.
+ */
+void TileHotData::reset(size_t size)
+{
+	TileCache def = { };
+	def.isNoFloor = 1;
+
+	cache.assign(size, def);
+	for (int layer = 0; layer < LL_MAX; layer++)
+	{
+		light[layer].assign(size, 0);
+	}
+	visible.assign(size, 0);
+}
+
 /**
  * constructor
  * @param pos Position.
+ * @param hot Storage for frequently used data of all tiles.
+ * @param index Index of this tile in `hot`.
  */
-Tile::Tile(Position pos): _pos(pos), _unit(0), _visible(false), _preview(-1), _TUMarker(-1), _overlaps(0)
+Tile::Tile(Position pos, TileHotData *hot, int index): _hot(hot), _index(index), _pos(pos), _unit(0), _preview(-1), _TUMarker(-1), _overlaps(0)
 {
 	for (int i = 0; i < O_MAX; ++i)
 	{
@@ -61,15 +80,10 @@ Tile::Tile(Position pos): _pos(pos), _unit(0), _visible(false), _preview(-1), _T
 		_mapData->SetID[i] = -1;
 		_objectsCache[i].currentFrame = 0;
 	}
-	for (int layer = 0; layer < LL_MAX; layer++)
-	{
-		_light[layer] = 0;
-	}
 	for (int i = 0; i < O_MAX; ++i)
 	{
 		_objectsCache[i].discovered = 0;
 	}
-	_cache.isNoFloor = 1;
 }
 
 /**
@@ -226,30 +240,77 @@ void Tile::setMapData(MapData *dat, int mapDataID, int mapDataSetID, TilePart pa
 	_objectsCache[part].isBackTileObject = dat ? dat->isBackTileObject() : 0;
 	if (part == O_FLOOR || part == O_OBJECT)
 	{
+		auto& cache = _hot->cache[_index];
 		int level = 0;
 
 		if (_objects[O_FLOOR])
 		{
 			level = _objects[O_FLOOR]->getTerrainLevel();
-			_cache.isNoFloor = _objects[O_FLOOR]->isNoFloor();
+			cache.isNoFloor = _objects[O_FLOOR]->isNoFloor();
 		}
 		else
 		{
-			_cache.isNoFloor = 1;
+			cache.isNoFloor = 1;
 		}
 		// whichever's higher, but not the sum.
 		if (_objects[O_OBJECT])
 		{
 			level = std::min(_objects[O_OBJECT]->getTerrainLevel(), level);
-			_cache.bigWall = _objects[O_OBJECT]->getBigWall() != 0;
+			cache.bigWall = _objects[O_OBJECT]->getBigWall() != 0;
 		}
 		else
 		{
-			_cache.bigWall = 0;
+			cache.bigWall = 0;
 		}
-		_cache.terrainLevel = level;
+		cache.terrainLevel = level;
 	}
 	updateSprite(part);
+	updateVoxelCache();
+}
+
+/**
+ * Sets storage for compact voxel data of this tile.
+ * @param cache Element of array owned by SavedBattleGame.
+ */
+void Tile::setVoxelCache(TileVoxelCache *cache)
+{
+	_voxelCache = cache;
+	updateVoxelCache();
+}
+
+/**
+ * Copy LOFT data of all parts to voxel cache, need to be called after any part change.
+ */
+void Tile::updateVoxelCache()
+{
+	if (!_voxelCache)
+	{
+		return;
+	}
+	auto& cache = *_voxelCache;
+	cache.parts = 0;
+	cache.ufoDoorParts = 0;
+	cache.gravLift = _objects[O_FLOOR] && _objects[O_FLOOR]->isGravLift();
+	for (int part = O_FLOOR; part < O_MAX; ++part)
+	{
+		auto mp = _objects[part];
+		if (mp)
+		{
+			cache.parts |= 1 << part;
+			if ((part == O_WESTWALL || part == O_NORTHWALL) && _objectsCache[part].isUfoDoor)
+			{
+				cache.ufoDoorParts |= 1 << part;
+			}
+			for (int layer = 0; layer < 12; ++layer)
+			{
+				cache.loftID[part][layer] = mp->getLoftID(layer);
+			}
+		}
+		else
+		{
+			std::fill(std::begin(cache.loftID[part]), std::end(cache.loftID[part]), 0);
+		}
+	}
 }
 
 /**
@@ -302,7 +363,7 @@ int Tile::getTUCost(int part, MovementType movementType) const
 bool Tile::hasNoFloor(const SavedBattleGame *savedBattleGame) const
 {
 	//There's no point in checking for "floor" below if we have floor in this tile already.
-	if (_cache.isNoFloor)
+	if (_hot->cache[_index].isNoFloor)
 	{
 		if (_pos.z > 0 && savedBattleGame)
 		{
@@ -312,7 +373,7 @@ bool Tile::hasNoFloor(const SavedBattleGame *savedBattleGame) const
 		}
 	}
 
-	return _cache.isNoFloor;
+	return _hot->cache[_index].isNoFloor;
 }
 
 /**
@@ -439,7 +500,7 @@ bool Tile::isDiscovered(TilePart part) const
  */
 void Tile::resetLight(LightLayers layer)
 {
-	_light[layer] = 0;
+	_hot->light[layer][_index] = 0;
 }
 
 /**
@@ -450,7 +511,7 @@ void Tile::resetLightMulti(LightLayers layer)
 {
 	for (int l = layer; l < LL_MAX; l++)
 	{
-		_light[l] = 0;
+		_hot->light[l][_index] = 0;
 	}
 }
 
@@ -461,8 +522,8 @@ void Tile::resetLightMulti(LightLayers layer)
  */
 void Tile::addLight(int light, LightLayers layer)
 {
-	if (_light[layer] < light)
-		_light[layer] = light;
+	if (_hot->light[layer][_index] < light)
+		_hot->light[layer][_index] = light;
 }
 
 /**
@@ -472,7 +533,7 @@ void Tile::addLight(int light, LightLayers layer)
  */
 int Tile::getLight(LightLayers layer) const
 {
-	return _light[layer];
+	return _hot->light[layer][_index];
 }
 
 int Tile::getLightMulti(LightLayers layer) const
@@ -481,8 +542,8 @@ int Tile::getLightMulti(LightLayers layer) const
 
 	for (int l = layer; l >= 0; --l)
 	{
-		if (_light[l] > light)
-			light = _light[l];
+		if (_hot->light[l][_index] > light)
+			light = _hot->light[l][_index];
 	}
 
 	return light;
@@ -500,8 +561,8 @@ int Tile::getShade() const
 
 	for (int layer = 0; layer < LL_MAX; layer++)
 	{
-		if (_light[layer] > light)
-			light = _light[layer];
+		if (_hot->light[layer][_index] > light)
+			light = _hot->light[layer][_index];
 	}
 
 	return std::max(0, 15 - light);
@@ -960,7 +1021,7 @@ int Tile::getMarkerColor() const
  */
 void Tile::setVisible(int visibility)
 {
-	_visible += visibility;
+	_hot->visible[_index] += visibility;
 }
 
 /**
@@ -969,7 +1030,7 @@ void Tile::setVisible(int visibility)
  */
 int Tile::getVisible() const
 {
-	return _visible;
+	return _hot->visible[_index];
 }
 
 /**
@@ -1030,7 +1091,7 @@ void Tile::addOverlap()
  */
 void Tile::setDangerous(bool danger)
 {
-	_cache.danger = danger;
+	_hot->cache[_index].danger = danger;
 }
 
 /**
@@ -1039,7 +1100,7 @@ void Tile::setDangerous(bool danger)
  */
 bool Tile::getDangerous() const
 {
-	return _cache.danger;
+	return _hot->cache[_index].danger;
 }
 
 /**
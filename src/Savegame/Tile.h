@@ -48,6 +48,50 @@ enum TileUnitOverlapping : int
 	TUO_ALWAYS = 0,
 };
 
+/**
+ * Compact copy of LOFT indexes of all tile parts, used by voxel checks.
+ * Stored by SavedBattleGame in one array for whole map.
+ */
+struct TileVoxelCache
+{
+	/// LOFT index for each part and each layer, same type as in MapData so no id is truncated.
+	int loftID[O_MAX][12];
+	/// Bit set for every part that exists.
+	Uint8 parts;
+	/// Bit set for every wall that is ufo door, they lose voxels when open.
+	Uint8 ufoDoorParts;
+	/// Floor is grav lift.
+	Uint8 gravLift;
+};
+
+/**
+ * Cached data that belongs to whole tile
+ */
+struct TileCache
+{
+	Sint8 terrainLevel = 0;
+	Uint8 isNoFloor:1;
+	Uint8 bigWall:1;
+	Uint8 danger:1;
+};
+
+/**
+ * Frequently accessed data of all tiles, stored in parallel arrays indexed by tile index.
+ * Owned by SavedBattleGame, each tile only access its own element.
+ */
+struct TileHotData
+{
+	/// Cached terrain data of each tile.
+	std::vector<TileCache> cache;
+	/// Light of each tile, separate array for each layer.
+	std::vector<Uint8> light[LL_MAX];
+	/// Visibility counter of each tile.
+	std::vector<int> visible;
+
+	/// Resets all arrays to default values for given number of tiles.
+	void reset(size_t size);
+};
+
 /**
  * Basic element of which a battle map is build.
  * @sa http://www.ufopaedia.org/index.php?title=MAPS
@@ -95,24 +139,15 @@ public:
 		Uint8 isDoor:1;
 		Uint8 isBackTileObject:1;
 	};
-	/**
-	 * Cached data that belongs to whole tile
-	 */
-	struct TileCache
-	{
-		Sint8 terrainLevel = 0;
-		Uint8 isNoFloor:1;
-		Uint8 bigWall:1;
-		Uint8 danger:1;
-	};
 
 protected:
 	MapData *_objects[O_MAX];
 	std::unique_ptr<TileMapDataCache> _mapData = std::make_unique<TileMapDataCache>();
 	SurfaceRaw<const Uint8> _currentSurface[O_MAX] = { };
 	TileObjectCache _objectsCache[O_MAX] = { };
-	TileCache _cache = { };
-	Uint8 _light[LL_MAX];
+	TileHotData *_hot;
+	int _index;
+	TileVoxelCache *_voxelCache = nullptr;
 	Uint8 _fire = 0;
 	Uint8 _smoke = 0;
 	Uint8 _markerColor = 0;
@@ -123,7 +158,6 @@ protected:
 	Position _pos;
 	BattleUnit *_unit;
 	std::vector<BattleItem *> _inventory;
-	int _visible;
 	int _preview;
 	int _TUMarker;
 	int _overlaps;
@@ -131,7 +165,7 @@ protected:
 
 public:
 	/// Creates a tile.
-	Tile(Position pos);
+	Tile(Position pos, TileHotData *hot, int index);
 	/// Copy constructor.
 	Tile(Tile&&) = default;
 	/// Cleans up a tile.
@@ -175,6 +209,10 @@ public:
 
 	/// Sets the pointer to the mapdata for a specific part of the tile
 	void setMapData(MapData *dat, int mapDataID, int mapDataSetID, TilePart part);
+	/// Sets storage for compact voxel data of this tile.
+	void setVoxelCache(TileVoxelCache *cache);
+	/// Refresh compact voxel data of this tile.
+	void updateVoxelCache();
 	/// Gets the IDs to the mapdata for a specific part of the tile
 	void getMapData(int *mapDataID, int *mapDataSetID, TilePart part) const;
 	/// Gets whether this tile has no objects
@@ -190,7 +228,7 @@ public:
 	 */
 	bool isBigWall() const
 	{
-		return _cache.bigWall;
+		return _hot->cache[_index].bigWall;
 	}
 
 	/**
@@ -199,7 +237,7 @@ public:
 	 */
 	int getTerrainLevel() const
 	{
-		return _cache.terrainLevel;
+		return _hot->cache[_index].terrainLevel;
 	}
 
 	/**
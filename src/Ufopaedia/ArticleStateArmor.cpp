@@ -52,7 +52,7 @@ namespace OpenXcom
 		Surface* customArmorSprite = nullptr;
 		if (!defs->image_id.empty() && bpp == 8)
 		{
-			_game->getMod()->getSurface(defs->image_id, true);
+			_game->getMod()->getSurfaceTransient(defs->image_id, true);
 		}
 		else if (!defs->image_id.empty())
 		{
@@ -160,17 +160,17 @@ namespace OpenXcom
 		{
 			std::string look = armor->getSpriteInventory();
 			look += "M0.SPK";
-			if (!_game->getMod()->getSurface(look, false))
+			if (!_game->getMod()->getSurfaceTransient(look, false))
 			{
 				look = armor->getSpriteInventory() + ".SPK";
 			}
-			if (!_game->getMod()->getSurface(look, false))
+			if (!_game->getMod()->getSurfaceTransient(look, false))
 			{
 				look = armor->getSpriteInventory();
 			}
 			if (bpp == 8)
 			{
-				_game->getMod()->getSurface(look, true)->blitNShade(_image, 0, 0);
+				_game->getMod()->getSurfaceTransient(look, true)->blitNShade(_image, 0, 0);
 			}
 			else
 			{
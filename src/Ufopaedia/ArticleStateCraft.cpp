@@ -47,7 +47,7 @@ namespace OpenXcom
 		// Set palette
 		if (defs->customPalette && bpp == 8)
 		{
-			setCustomPalette(_game->getMod()->getSurface(defs->image_id)->getPalette(), Mod::UFOPAEDIA_CURSOR);
+			setCustomPalette(_game->getMod()->getSurfaceTransient(defs->image_id)->getPalette(), Mod::UFOPAEDIA_CURSOR);
 		}
 		else if (bpp == 8)
 		{
@@ -74,7 +74,7 @@ namespace OpenXcom
 		// Set up objects
 		if (Options::pediaBgResolutionX == Screen::ORIGINAL_WIDTH)
 		{
-			_game->getMod()->getSurface(defs->image_id)->blitNShade(_bg, 0, 0);
+			_game->getMod()->getSurfaceTransient(defs->image_id)->blitNShade(_bg, 0, 0);
 		}
 		else
 		{
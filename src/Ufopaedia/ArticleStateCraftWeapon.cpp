@@ -63,7 +63,7 @@ namespace OpenXcom
 		// Set palette
 		if (defs->customPalette && bpp == 8)
 		{
-			setCustomPalette(_game->getMod()->getSurface(defs->image_id)->getPalette(), Mod::BATTLESCAPE_CURSOR);
+			setCustomPalette(_game->getMod()->getSurfaceTransient(defs->image_id)->getPalette(), Mod::BATTLESCAPE_CURSOR);
 		}
 		else if (bpp == 8)
 		{
@@ -106,7 +106,7 @@ namespace OpenXcom
 		// Set up objects
 		if (bpp == 8)
 		{
-			_game->getMod()->getSurface(defs->image_id)->blitNShade(_bg, 0, 0);
+			_game->getMod()->getSurfaceTransient(defs->image_id)->blitNShade(_bg, 0, 0);
 		}
 		else
 		{
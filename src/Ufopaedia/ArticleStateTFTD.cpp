@@ -88,7 +88,7 @@ namespace OpenXcom
 				else
 					_cursorColor = Mod::BATTLESCAPE_CURSOR;
 
-				setCustomPalette(_game->getMod()->getSurface(defs->image_id)->getPalette(), _cursorColor);
+				setCustomPalette(_game->getMod()->getSurfaceTransient(defs->image_id)->getPalette(), _cursorColor);
 			}
 			else
 			{
@@ -162,7 +162,7 @@ namespace OpenXcom
 		}
 
 		// Step 2: article image (optional)
-		Surface *image = _game->getMod()->getSurface(defs->image_id, false);
+		Surface *image = _game->getMod()->getSurfaceTransient(defs->image_id, false);
 		if (image)
 		{
 			if (bpp == 8) {
@@ -25,7 +25,11 @@
 #include "Engine/Game.h"
 #include "Engine/Options.h"
 #include "Engine/FileMap.h"
+#include "Engine/ShaderDrawSimd.h"
+#include "Engine/Script.h"
 #include "Menu/StartState.h"
+#include "Savegame/BackgroundSaver.h"
+#include "Savegame/SaveFormat.h"
 
 /** @mainpage
  * @author OpenXcom Developers
@@ -112,6 +116,23 @@ int main(int argc, char *argv[])
 	CrossPlatform::processArgs(argc, argv);
 	if (!Options::init())
 		return EXIT_SUCCESS;
+	if (Options::oxceBenchmarkBlit)
+	{
+		helper::benchmarkShaderRowKernels();
+	}
+	if (Options::oxceBenchmarkScripts)
+	{
+		benchmarkScripts();
+	}
+	// Convert save between YAML and binary format and quit
+	const std::vector<std::string> &args = CrossPlatform::getArgs();
+	for (size_t i = 1; i + 1 < args.size(); ++i)
+	{
+		if (args[i] == "-convertSave" || args[i] == "--convertSave")
+		{
+			return SaveFormat::convert(args[i + 1]) ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
 	std::ostringstream title;
 	title << "OpenXcom " << OPENXCOM_VERSION_SHORT << OPENXCOM_VERSION_GIT;
 	Options::baseXResolution = Options::displayWidth;
@@ -121,6 +142,12 @@ int main(int argc, char *argv[])
 	State::setGamePtr(game);
 	game->setState(new StartState);
 	game->run();
+	BackgroundSaver::getInstance().wait();
+	std::string saveError = BackgroundSaver::getInstance().takeError();
+	if (!saveError.empty())
+	{
+		Log(LOG_ERROR) << saveError;
+	}
 
 	bool startUpdate = game->getUpdateFlag();
 